@@ -0,0 +1,546 @@
+#pragma once
+
+#include "predicate_optimizer/hash.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace predicate_optimizer {
+namespace detail {
+// Set bits of the given bitset from a string of '0' and '1', the rightmost character is the bit 0.
+template <typename BitsetT>
+void parseBits(std::string_view bits, BitsetT& bitset) {
+    for (size_t i = 0; i < bits.size(); ++i) {
+        const char ch = bits[bits.size() - 1 - i];
+        if (ch == '1') {
+            bitset.set(i);
+        } else if (ch != '0') {
+            throw std::invalid_argument("Bitset string must consist of '0' and '1'");
+        }
+    }
+}
+
+// Print the bits of the given bitset without leading zeros.
+template <typename BitsetT>
+std::ostream& printBits(std::ostream& os, const BitsetT& bitset) {
+    size_t numBits = bitset.significantWords() * BitsetT::kWordBits;
+    while (numBits > 1 && !bitset.test(numBits - 1)) {
+        --numBits;
+    }
+    for (size_t i = std::max<size_t>(numBits, 1); i > 0; --i) {
+        os << (bitset.test(i - 1) ? '1' : '0');
+    }
+    return os;
+}
+}  // namespace detail
+
+/**
+ * A set of bits of arbitrary width. Bits beyond the allocated words are treated as zeros, so
+ * bitsets of different widths can be combined freely and compare equal if they have the same bits
+ * set. Up to 64 bits are stored inline in a single machine word, wider bitsets allocate their word
+ * array once, normally sized for all predicates of an expression.
+ */
+class Bitset {
+public:
+    using Word = std::uint64_t;
+    static constexpr size_t kWordBits = 64;
+
+    Bitset() noexcept : _numWords(1) {
+        _storage.word = 0;
+    }
+
+    // Construct the bitset from a string of '0' and '1', the rightmost character is the bit 0.
+    explicit Bitset(std::string_view bits) : Bitset(zeros(bits.size())) {
+        detail::parseBits(bits, *this);
+    }
+
+    explicit Bitset(const char* bits) : Bitset(std::string_view{bits}) {}
+
+    // Return a bitset with all bits unset and enough storage to hold the given number of bits.
+    static Bitset zeros(size_t numBits) {
+        Bitset result{};
+        result.resize(wordsFor(numBits));
+        return result;
+    }
+
+    // Return a bitset holding a copy of the given words.
+    static Bitset fromWords(const Word* words, size_t numWords) {
+        Bitset result{};
+        result.resize(numWords);
+        std::copy_n(words, numWords, result.data());
+        return result;
+    }
+
+    Bitset(const Bitset& other) : _numWords(other._numWords) {
+        if (isInline()) {
+            _storage.word = other._storage.word;
+        } else {
+            _storage.words = new Word[_numWords];
+            std::copy_n(other._storage.words, _numWords, _storage.words);
+        }
+    }
+
+    Bitset(Bitset&& other) noexcept : _numWords(other._numWords), _storage(other._storage) {
+        other._numWords = 1;
+        other._storage.word = 0;
+    }
+
+    ~Bitset() noexcept {
+        if (!isInline()) {
+            delete[] _storage.words;
+        }
+    }
+
+    Bitset& operator=(const Bitset& other) {
+        if (this != &other) {
+            if (_numWords == other._numWords) {
+                std::copy_n(other.data(), _numWords, data());
+            } else {
+                Bitset copy{other};
+                swap(copy);
+            }
+        }
+        return *this;
+    }
+
+    Bitset& operator=(Bitset&& other) noexcept {
+        Bitset moved{std::move(other)};
+        swap(moved);
+        return *this;
+    }
+
+    void swap(Bitset& other) noexcept {
+        std::swap(_numWords, other._numWords);
+        std::swap(_storage, other._storage);
+    }
+
+    // Number of bits the bitset can hold without growing.
+    size_t size() const noexcept {
+        return _numWords * kWordBits;
+    }
+
+    size_t numWords() const noexcept {
+        return _numWords;
+    }
+
+    const Word* data() const noexcept {
+        return isInline() ? &_storage.word : _storage.words;
+    }
+
+    Word* data() noexcept {
+        return isInline() ? &_storage.word : _storage.words;
+    }
+
+    bool test(size_t index) const noexcept {
+        const size_t wordIndex = index / kWordBits;
+        return wordIndex < _numWords && ((data()[wordIndex] >> (index % kWordBits)) & 1);
+    }
+
+    bool operator[](size_t index) const noexcept {
+        return test(index);
+    }
+
+    Bitset& set(size_t index, bool value = true) {
+        const size_t wordIndex = index / kWordBits;
+        if (wordIndex >= _numWords) {
+            if (!value) {
+                return *this;
+            }
+            resize(wordIndex + 1);
+        }
+
+        const Word bit = Word{1} << (index % kWordBits);
+        if (value) {
+            data()[wordIndex] |= bit;
+        } else {
+            data()[wordIndex] &= ~bit;
+        }
+        return *this;
+    }
+
+    Bitset& reset(size_t index) {
+        return set(index, false);
+    }
+
+    size_t count() const noexcept {
+        size_t result = 0;
+        const Word* words = data();
+        for (size_t i = 0; i < _numWords; ++i) {
+            result += std::popcount(words[i]);
+        }
+        return result;
+    }
+
+    bool any() const noexcept {
+        const Word* words = data();
+        for (size_t i = 0; i < _numWords; ++i) {
+            if (words[i] != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool none() const noexcept {
+        return !any();
+    }
+
+    // Return true if every bit set in this bitset is set in the other one.
+    bool isSubsetOf(const Bitset& other) const noexcept {
+        const Word* words = data();
+        const Word* otherWords = other.data();
+        for (size_t i = 0; i < _numWords; ++i) {
+            const Word otherWord = i < other._numWords ? otherWords[i] : 0;
+            if ((words[i] & ~otherWord) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Call the function with the index of every set bit in increasing order.
+    template <typename Function>
+    void forEachSetBit(Function&& function) const {
+        const Word* words = data();
+        for (size_t i = 0; i < _numWords; ++i) {
+            for (Word word = words[i]; word != 0; word &= word - 1) {
+                function(i * kWordBits + std::countr_zero(word));
+            }
+        }
+    }
+
+    Bitset& operator&=(const Bitset& rhs) noexcept {
+        const size_t common = std::min(_numWords, rhs._numWords);
+        Word* lhsWords = data();
+        const Word* rhsWords = rhs.data();
+        for (size_t i = 0; i < common; ++i) {
+            lhsWords[i] &= rhsWords[i];
+        }
+        std::fill(lhsWords + common, lhsWords + _numWords, Word{0});
+        return *this;
+    }
+
+    Bitset& operator|=(const Bitset& rhs) {
+        if (_numWords < rhs._numWords) {
+            resize(rhs._numWords);
+        }
+        Word* lhsWords = data();
+        const Word* rhsWords = rhs.data();
+        for (size_t i = 0; i < rhs._numWords; ++i) {
+            lhsWords[i] |= rhsWords[i];
+        }
+        return *this;
+    }
+
+    Bitset& operator^=(const Bitset& rhs) {
+        if (_numWords < rhs._numWords) {
+            resize(rhs._numWords);
+        }
+        Word* lhsWords = data();
+        const Word* rhsWords = rhs.data();
+        for (size_t i = 0; i < rhs._numWords; ++i) {
+            lhsWords[i] ^= rhsWords[i];
+        }
+        return *this;
+    }
+
+    friend Bitset operator&(Bitset lhs, const Bitset& rhs) noexcept {
+        lhs &= rhs;
+        return lhs;
+    }
+
+    friend Bitset operator|(Bitset lhs, const Bitset& rhs) {
+        lhs |= rhs;
+        return lhs;
+    }
+
+    friend Bitset operator^(Bitset lhs, const Bitset& rhs) {
+        lhs ^= rhs;
+        return lhs;
+    }
+
+    friend bool operator==(const Bitset& lhs, const Bitset& rhs) noexcept {
+        const size_t common = std::min(lhs._numWords, rhs._numWords);
+        if (!std::equal(lhs.data(), lhs.data() + common, rhs.data())) {
+            return false;
+        }
+        const auto isZero = [](Word word) { return word == 0; };
+        return std::all_of(lhs.data() + common, lhs.data() + lhs._numWords, isZero) &&
+            std::all_of(rhs.data() + common, rhs.data() + rhs._numWords, isZero);
+    }
+
+    friend bool operator!=(const Bitset& lhs, const Bitset& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+
+    // Number of words up to and including the last non-zero one.
+    size_t significantWords() const noexcept {
+        size_t result = _numWords;
+        while (result > 0 && data()[result - 1] == 0) {
+            --result;
+        }
+        return result;
+    }
+
+    static constexpr size_t wordsFor(size_t numBits) noexcept {
+        return numBits == 0 ? 1 : (numBits + kWordBits - 1) / kWordBits;
+    }
+
+private:
+    bool isInline() const noexcept {
+        return _numWords == 1;
+    }
+
+    // Grow the storage to the given number of words, new words are zero-filled.
+    void resize(size_t numWords) {
+        if (numWords <= _numWords) {
+            return;
+        }
+
+        Word* words = new Word[numWords];
+        std::copy_n(data(), _numWords, words);
+        std::fill(words + _numWords, words + numWords, Word{0});
+        if (!isInline()) {
+            delete[] _storage.words;
+        }
+        _storage.words = words;
+        _numWords = numWords;
+    }
+
+    union Storage {
+        Word word;
+        Word* words;
+    };
+
+    size_t _numWords;
+    Storage _storage;
+};
+
+inline void swap(Bitset& lhs, Bitset& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+inline std::ostream& operator<<(std::ostream& os, const Bitset& bitset) {
+    return detail::printBits(os, bitset);
+}
+
+/**
+ * A bitset of a fixed number of words, the counterpart of Bitset for expressions whose predicate
+ * count is known to fit. All operations are straight-line code over a std::array which the
+ * compiler fully unrolls for the one, two and four word instantiations used by the algebra.
+ */
+template <size_t NumWords>
+class FixedBitset {
+public:
+    using Word = Bitset::Word;
+    static constexpr size_t kWordBits = Bitset::kWordBits;
+    static constexpr size_t kNumWords = NumWords;
+
+    constexpr FixedBitset() noexcept : _words{} {}
+
+    explicit FixedBitset(std::string_view bits) : _words{} {
+        assert(bits.size() <= size());
+        detail::parseBits(bits, *this);
+    }
+
+    explicit FixedBitset(const char* bits) : FixedBitset(std::string_view{bits}) {}
+
+    static FixedBitset zeros(size_t numBits) noexcept {
+        assert(numBits <= NumWords * kWordBits);
+        return {};
+    }
+
+    // Return a bitset holding a copy of the given words, all words past NumWords must be zeros.
+    static FixedBitset fromWords(const Word* words, size_t numWords) noexcept {
+        FixedBitset result{};
+        for (size_t i = 0; i < std::min(numWords, NumWords); ++i) {
+            result._words[i] = words[i];
+        }
+        assert(std::all_of(words + std::min(numWords, NumWords),
+                           words + numWords,
+                           [](Word word) { return word == 0; }));
+        return result;
+    }
+
+    static constexpr size_t size() noexcept {
+        return NumWords * kWordBits;
+    }
+
+    static constexpr size_t numWords() noexcept {
+        return NumWords;
+    }
+
+    const Word* data() const noexcept {
+        return _words.data();
+    }
+
+    Word* data() noexcept {
+        return _words.data();
+    }
+
+    bool test(size_t index) const noexcept {
+        const size_t wordIndex = index / kWordBits;
+        return wordIndex < NumWords && ((_words[wordIndex] >> (index % kWordBits)) & 1);
+    }
+
+    bool operator[](size_t index) const noexcept {
+        return test(index);
+    }
+
+    FixedBitset& set(size_t index, bool value = true) noexcept {
+        assert(index < size());
+        const Word bit = Word{1} << (index % kWordBits);
+        if (value) {
+            _words[index / kWordBits] |= bit;
+        } else {
+            _words[index / kWordBits] &= ~bit;
+        }
+        return *this;
+    }
+
+    FixedBitset& reset(size_t index) noexcept {
+        return set(index, false);
+    }
+
+    size_t count() const noexcept {
+        size_t result = 0;
+        for (size_t i = 0; i < NumWords; ++i) {
+            result += std::popcount(_words[i]);
+        }
+        return result;
+    }
+
+    bool any() const noexcept {
+        Word result = 0;
+        for (size_t i = 0; i < NumWords; ++i) {
+            result |= _words[i];
+        }
+        return result != 0;
+    }
+
+    bool none() const noexcept {
+        return !any();
+    }
+
+    bool isSubsetOf(const FixedBitset& other) const noexcept {
+        Word result = 0;
+        for (size_t i = 0; i < NumWords; ++i) {
+            result |= _words[i] & ~other._words[i];
+        }
+        return result == 0;
+    }
+
+    template <typename Function>
+    void forEachSetBit(Function&& function) const {
+        for (size_t i = 0; i < NumWords; ++i) {
+            for (Word word = _words[i]; word != 0; word &= word - 1) {
+                function(i * kWordBits + std::countr_zero(word));
+            }
+        }
+    }
+
+    FixedBitset& operator&=(const FixedBitset& rhs) noexcept {
+        for (size_t i = 0; i < NumWords; ++i) {
+            _words[i] &= rhs._words[i];
+        }
+        return *this;
+    }
+
+    FixedBitset& operator|=(const FixedBitset& rhs) noexcept {
+        for (size_t i = 0; i < NumWords; ++i) {
+            _words[i] |= rhs._words[i];
+        }
+        return *this;
+    }
+
+    FixedBitset& operator^=(const FixedBitset& rhs) noexcept {
+        for (size_t i = 0; i < NumWords; ++i) {
+            _words[i] ^= rhs._words[i];
+        }
+        return *this;
+    }
+
+    friend FixedBitset operator&(FixedBitset lhs, const FixedBitset& rhs) noexcept {
+        lhs &= rhs;
+        return lhs;
+    }
+
+    friend FixedBitset operator|(FixedBitset lhs, const FixedBitset& rhs) noexcept {
+        lhs |= rhs;
+        return lhs;
+    }
+
+    friend FixedBitset operator^(FixedBitset lhs, const FixedBitset& rhs) noexcept {
+        lhs ^= rhs;
+        return lhs;
+    }
+
+    friend bool operator==(const FixedBitset& lhs, const FixedBitset& rhs) noexcept {
+        return lhs._words == rhs._words;
+    }
+
+    friend bool operator!=(const FixedBitset& lhs, const FixedBitset& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+
+    size_t significantWords() const noexcept {
+        size_t result = NumWords;
+        while (result > 0 && _words[result - 1] == 0) {
+            --result;
+        }
+        return result;
+    }
+
+private:
+    std::array<Word, NumWords> _words;
+};
+
+template <size_t NumWords>
+std::ostream& operator<<(std::ostream& os, const FixedBitset<NumWords>& bitset) {
+    return detail::printBits(os, bitset);
+}
+
+// Convert between bitset types, the target must be wide enough to hold all set bits.
+template <typename To, typename From>
+To bitset_cast(const From& from) {
+    if constexpr (std::is_same_v<To, From>) {
+        return from;
+    } else {
+        return To::fromWords(from.data(), from.numWords());
+    }
+}
+}  // namespace predicate_optimizer
+
+namespace std {
+template <>
+struct hash<predicate_optimizer::Bitset> {
+    using argument_type = predicate_optimizer::Bitset;
+    using result_type = size_t;
+
+    result_type operator()(const argument_type& bitset) const {
+        // Trailing zero words are skipped to keep the hash consistent with equality.
+        const auto* words = bitset.data();
+        return hash_range(words, words + bitset.significantWords());
+    }
+};
+
+template <size_t NumWords>
+struct hash<predicate_optimizer::FixedBitset<NumWords>> {
+    using argument_type = predicate_optimizer::FixedBitset<NumWords>;
+    using result_type = size_t;
+
+    result_type operator()(const argument_type& bitset) const {
+        // Hashes the same way as the equal Bitset.
+        const auto* words = bitset.data();
+        return hash_range(words, words + bitset.significantWords());
+    }
+};
+}  // namespace std
@@ -3,21 +3,26 @@
 
 namespace predicate_optimizer {
 
-Maxterm::Maxterm() {}
+template <typename BitsetT>
+BasicMaxterm<BitsetT>::BasicMaxterm() {}
 
-Maxterm::Maxterm(std::initializer_list<Minterm> init) : minterms(std::move(init)) {}
+template <typename BitsetT>
+BasicMaxterm<BitsetT>::BasicMaxterm(std::initializer_list<MintermType> init)
+    : minterms(std::move(init)) {}
 
-Maxterm& Maxterm::operator|=(const Minterm& rhs) {
+template <typename BitsetT>
+BasicMaxterm<BitsetT>& BasicMaxterm<BitsetT>::operator|=(const MintermType& rhs) {
     minterms.emplace_back(rhs);
     return *this;
 }
 
-Maxterm Maxterm::operator~() const {
+template <typename BitsetT>
+BasicMaxterm<BitsetT> BasicMaxterm<BitsetT>::operator~() const {
     if (minterms.empty()) {
-        return {Minterm{}};
+        return {MintermType{}};
     }
 
-    Maxterm result = ~minterms.front();
+    BasicMaxterm result = ~minterms.front();
     for (size_t i = 1; i < minterms.size(); ++i) {
         result &= ~minterms[i];
     }
@@ -25,43 +30,60 @@ Maxterm Maxterm::operator~() const {
     return result;
 }
 
-Maxterm Minterm::operator~() const {
-    Maxterm result = {};
+template <typename BitsetT>
+BasicMaxterm<BitsetT> BasicMinterm<BitsetT>::operator~() const {
+    BasicMaxterm<BitsetT> result = {};
     for (size_t i = 0; i < mask.size(); ++i) {
         if (mask[i]) {
-            result |= Minterm(i, !bitset[i]);
+            auto minterm = withSize(mask.size());
+            minterm.set(i, !bitset[i]);
+            result |= minterm;
         }
     }
     return result;
 }
 
-bool operator==(const Minterm& lhs, const Minterm& rhs) {
-    return lhs.bitset == rhs.bitset && lhs.mask == rhs.mask;
-}
-
-std::ostream& operator<<(std::ostream& os, const Minterm& minterm) {
+template <typename BitsetT>
+std::ostream& operator<<(std::ostream& os, const BasicMinterm<BitsetT>& minterm) {
     os << '(' << minterm.bitset << ", " << minterm.mask << ")";
     return os;
 }
 
-Maxterm& Maxterm::operator|=(const Maxterm& rhs) {
+template <typename BitsetT>
+BasicMaxterm<BitsetT>& BasicMaxterm<BitsetT>::operator|=(const BasicMaxterm& rhs) {
     for (auto& right : rhs.minterms) {
         *this |= right;
     }
     return *this;
 }
 
-Maxterm& Maxterm::operator&=(const Maxterm& rhs) {
-    Maxterm result = *this & rhs;
+template <typename BitsetT>
+BasicMaxterm<BitsetT>& BasicMaxterm<BitsetT>::operator&=(const BasicMaxterm& rhs) {
+    BasicMaxterm result = *this & rhs;
     minterms.swap(result.minterms);
     return *this;
 }
 
-bool operator==(const Maxterm& lhs, const Maxterm& rhs) {
-    return lhs.minterms == rhs.minterms;
-}
-
-std::ostream& operator<<(std::ostream& os, const Maxterm& maxterm) {
+template <typename BitsetT>
+std::ostream& operator<<(std::ostream& os, const BasicMaxterm<BitsetT>& maxterm) {
     return os << maxterm.minterms;
 }
+
+template struct BasicMinterm<Bitset>;
+template struct BasicMinterm<FixedBitset<1>>;
+template struct BasicMinterm<FixedBitset<2>>;
+template struct BasicMinterm<FixedBitset<4>>;
+template struct BasicMaxterm<Bitset>;
+template struct BasicMaxterm<FixedBitset<1>>;
+template struct BasicMaxterm<FixedBitset<2>>;
+template struct BasicMaxterm<FixedBitset<4>>;
+
+template std::ostream& operator<<(std::ostream&, const BasicMinterm<Bitset>&);
+template std::ostream& operator<<(std::ostream&, const BasicMinterm<FixedBitset<1>>&);
+template std::ostream& operator<<(std::ostream&, const BasicMinterm<FixedBitset<2>>&);
+template std::ostream& operator<<(std::ostream&, const BasicMinterm<FixedBitset<4>>&);
+template std::ostream& operator<<(std::ostream&, const BasicMaxterm<Bitset>&);
+template std::ostream& operator<<(std::ostream&, const BasicMaxterm<FixedBitset<1>>&);
+template std::ostream& operator<<(std::ostream&, const BasicMaxterm<FixedBitset<2>>&);
+template std::ostream& operator<<(std::ostream&, const BasicMaxterm<FixedBitset<4>>&);
 }  // namespace predicate_optimizer
@@ -1,45 +1,57 @@
 #pragma once
 
+#include "predicate_optimizer/bitset.h"
 #include "predicate_optimizer/hash.h"
-#include <bitset>
 #include <iosfwd>
+#include <type_traits>
 #include <vector>
 
 namespace predicate_optimizer {
 
-using Bitset = std::bitset<16>;
-
 inline Bitset operator""_b(const char* bits, size_t) {
     return Bitset{bits};
 }
 
-struct Minterm;
+/**
+ * The algebra is a template on the bitset type, it is instantiated for one, two and four word
+ * FixedBitsets and for the dynamic Bitset, see dispatchByWidth(). Minterm and Maxterm are the
+ * dynamic instantiations used in the public interfaces.
+ */
+template <typename BitsetT>
+struct BasicMinterm;
 
-struct Maxterm {
-    Maxterm();
-    Maxterm(std::initializer_list<Minterm> init);
+template <typename BitsetT>
+struct BasicMaxterm {
+    using MintermType = BasicMinterm<BitsetT>;
 
-    Maxterm& operator|=(const Minterm& rhs);
-    Maxterm& operator|=(const Maxterm& rhs);
-    Maxterm& operator&=(const Maxterm& rhs);
-    Maxterm operator~() const;
+    BasicMaxterm();
+    BasicMaxterm(std::initializer_list<MintermType> init);
 
-    friend Maxterm operator&(const Maxterm& lhs, const Maxterm& rhs);
+    BasicMaxterm& operator|=(const MintermType& rhs);
+    BasicMaxterm& operator|=(const BasicMaxterm& rhs);
+    BasicMaxterm& operator&=(const BasicMaxterm& rhs);
+    BasicMaxterm operator~() const;
 
-    std::vector<Minterm> minterms;
+    std::vector<MintermType> minterms;
 };
 
-struct Minterm {
-    Minterm() : bitset(0), mask(0){};
-    Minterm(const char* bits, const char* mask) : bitset{bits}, mask{mask} {}
-    Minterm(size_t bitIndex, bool val) : bitset(0), mask(0) {
+template <typename BitsetT>
+struct BasicMinterm {
+    BasicMinterm() {}
+    BasicMinterm(const char* bits, const char* mask) : bitset{bits}, mask{mask} {}
+    BasicMinterm(size_t bitIndex, bool val) {
         bitset.set(bitIndex, val);
         mask.set(bitIndex, true);
     }
-    Minterm(Bitset bitset, Bitset mask) : bitset(bitset), mask(mask) {}
+    BasicMinterm(BitsetT bitset, BitsetT mask) : bitset(std::move(bitset)), mask(std::move(mask)) {}
+
+    // Create an empty minterm which can hold the given number of bits without reallocations.
+    static BasicMinterm withSize(size_t numBits) {
+        return {BitsetT::zeros(numBits), BitsetT::zeros(numBits)};
+    }
 
-    Minterm flip() const {
-        return {~bitset & mask, mask};
+    BasicMinterm flip() const {
+        return {mask ^ (bitset & mask), mask};
     }
 
     void set(size_t bitIndex, bool value) {
@@ -47,45 +59,132 @@ struct Minterm {
         bitset.set(bitIndex, value);
     }
 
-    inline Bitset getConflicts(const Minterm& other) const {
+    inline BitsetT getConflicts(const BasicMinterm& other) const {
         return (bitset ^ other.bitset) & (mask & other.mask);
     }
 
-    Maxterm operator~() const;
+    // Return true if the literals of this minterm are a subset of the literals of the other one,
+    // so that this | other == this.
+    inline bool absorbs(const BasicMinterm& other) const {
+        return (mask & other.mask) == mask && getConflicts(other).none();
+    }
+
+    BasicMaxterm<BitsetT> operator~() const;
 
-    Bitset bitset;
-    Bitset mask;
+    BitsetT bitset;
+    BitsetT mask;
 };
 
-inline Maxterm operator&(const Minterm& lhs, const Minterm& rhs) {
+using Minterm = BasicMinterm<Bitset>;
+using Maxterm = BasicMaxterm<Bitset>;
+
+template <typename BitsetT>
+inline BasicMaxterm<BitsetT> operator&(const BasicMinterm<BitsetT>& lhs,
+                                       const BasicMinterm<BitsetT>& rhs) {
     if (lhs.getConflicts(rhs).any()) {
         return {};
     }
-    return {{Minterm(lhs.bitset | rhs.bitset, lhs.mask | rhs.mask)}};
+    return {{lhs.bitset | rhs.bitset, lhs.mask | rhs.mask}};
 }
 
-inline Maxterm operator&(const Maxterm& lhs, const Maxterm& rhs) {
-    Maxterm result{};
+namespace detail {
+template <typename BitsetT>
+inline BasicMaxterm<BitsetT> rowWiseProduct(const BasicMaxterm<BitsetT>& lhs,
+                                            const BasicMaxterm<BitsetT>& rhs) {
+    BasicMaxterm<BitsetT> result{};
     result.minterms.reserve(lhs.minterms.size() * rhs.minterms.size());
     for (const auto& left : lhs.minterms) {
         for (const auto& right : rhs.minterms) {
-            result |= left & right;
+            if (left.getConflicts(right).none()) {
+                result.minterms.emplace_back(left.bitset | right.bitset, left.mask | right.mask);
+            }
         }
     }
     return result;
 }
+}  // namespace detail
+
+template <typename BitsetT>
+inline BasicMaxterm<BitsetT> operator&(const BasicMaxterm<BitsetT>& lhs,
+                                       const BasicMaxterm<BitsetT>& rhs) {
+    return detail::rowWiseProduct(lhs, rhs);
+}
+
+// Fixed width maxterms are multiplied by the columnar kernel, see columnar_maxterm.h.
+template <size_t NumWords>
+BasicMaxterm<FixedBitset<NumWords>> operator&(const BasicMaxterm<FixedBitset<NumWords>>& lhs,
+                                              const BasicMaxterm<FixedBitset<NumWords>>& rhs);
+
+template <typename BitsetT>
+bool operator==(const BasicMinterm<BitsetT>& lhs, const BasicMinterm<BitsetT>& rhs) {
+    return lhs.bitset == rhs.bitset && lhs.mask == rhs.mask;
+}
+
+template <typename BitsetT>
+bool operator==(const BasicMaxterm<BitsetT>& lhs, const BasicMaxterm<BitsetT>& rhs) {
+    return lhs.minterms == rhs.minterms;
+}
+
+template <typename BitsetT>
+std::ostream& operator<<(std::ostream& os, const BasicMinterm<BitsetT>& minterm);
+template <typename BitsetT>
+std::ostream& operator<<(std::ostream& os, const BasicMaxterm<BitsetT>& maxterm);
+
+// Convert the minterm to another bitset type, the target must be wide enough to hold all bits.
+template <typename To, typename From>
+BasicMinterm<To> minterm_cast(const BasicMinterm<From>& minterm) {
+    return {bitset_cast<To>(minterm.bitset), bitset_cast<To>(minterm.mask)};
+}
+
+template <typename To, typename From>
+BasicMaxterm<To> maxterm_cast(BasicMaxterm<From> maxterm) {
+    if constexpr (std::is_same_v<To, From>) {
+        return maxterm;
+    } else {
+        BasicMaxterm<To> result{};
+        result.minterms.reserve(maxterm.minterms.size());
+        for (const auto& minterm : maxterm.minterms) {
+            result.minterms.emplace_back(minterm_cast<To>(minterm));
+        }
+        return result;
+    }
+}
+
+/**
+ * Call the function with std::type_identity of the narrowest bitset type able to hold the given
+ * number of bits: FixedBitset of one, two or four words, or the dynamic Bitset for wider sets.
+ */
+template <typename Function>
+decltype(auto) dispatchByWidth(size_t numBits, Function&& function) {
+    switch (Bitset::wordsFor(numBits)) {
+        case 1:
+            return function(std::type_identity<FixedBitset<1>>{});
+        case 2:
+            return function(std::type_identity<FixedBitset<2>>{});
+        case 3:
+            [[fallthrough]];
+        case 4:
+            return function(std::type_identity<FixedBitset<4>>{});
+        default:
+            return function(std::type_identity<Bitset>{});
+    }
+}
 
-bool operator==(const Minterm& lhs, const Minterm& rhs);
-std::ostream& operator<<(std::ostream& os, const Minterm& minterm);
-bool operator==(const Maxterm& lhs, const Maxterm& rhs);
-std::ostream& operator<<(std::ostream& os, const Maxterm& maxterm);
+extern template struct BasicMinterm<Bitset>;
+extern template struct BasicMinterm<FixedBitset<1>>;
+extern template struct BasicMinterm<FixedBitset<2>>;
+extern template struct BasicMinterm<FixedBitset<4>>;
+extern template struct BasicMaxterm<Bitset>;
+extern template struct BasicMaxterm<FixedBitset<1>>;
+extern template struct BasicMaxterm<FixedBitset<2>>;
+extern template struct BasicMaxterm<FixedBitset<4>>;
 
 }  // namespace predicate_optimizer
 
 namespace std {
-template <>
-struct hash<predicate_optimizer::Minterm> {
-    using argument_type = predicate_optimizer::Minterm;
+template <typename BitsetT>
+struct hash<predicate_optimizer::BasicMinterm<BitsetT>> {
+    using argument_type = predicate_optimizer::BasicMinterm<BitsetT>;
     using result_type = size_t;
 
     result_type operator()(const argument_type& mt) const {
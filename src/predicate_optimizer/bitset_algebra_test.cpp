@@ -2,6 +2,98 @@
 #include "predicate_optimizer/bitset_algebra.h"
 
 namespace predicate_optimizer {
+TEST_CASE("Bitset") {
+    SECTION("bitsets of different widths") {
+        auto wide = Bitset::zeros(200);
+        wide.set(1);
+        REQUIRE(wide.numWords() == 4);
+        REQUIRE(wide == "10"_b);
+        REQUIRE(std::hash<Bitset>{}(wide) == std::hash<Bitset>{}("10"_b));
+
+        wide.set(130);
+        REQUIRE(wide != "10"_b);
+        REQUIRE((wide & "11"_b) == "10"_b);
+        REQUIRE((wide ^ "10"_b).count() == 1);
+        REQUIRE((wide ^ "10"_b)[130]);
+    }
+
+    SECTION("set beyond the inline word") {
+        Bitset bitset{};
+        bitset.set(3);
+        bitset.set(70);
+        REQUIRE(bitset.count() == 2);
+        REQUIRE(bitset[3]);
+        REQUIRE(bitset[70]);
+        REQUIRE_FALSE(bitset[71]);
+        REQUIRE_FALSE(bitset[1000]);
+
+        bitset.reset(70);
+        REQUIRE(bitset == "1000"_b);
+    }
+
+    SECTION("copy and move") {
+        auto bitset = Bitset::zeros(100);
+        bitset.set(99);
+        auto copy = bitset;
+        auto moved = std::move(bitset);
+        REQUIRE(copy == moved);
+        REQUIRE(moved[99]);
+    }
+}
+
+TEST_CASE("FixedBitset") {
+    SECTION("conversions") {
+        auto wide = Bitset::zeros(128);
+        wide.set(0);
+        wide.set(127);
+
+        auto fixed = bitset_cast<FixedBitset<2>>(wide);
+        REQUIRE(fixed.count() == 2);
+        REQUIRE(fixed[127]);
+        REQUIRE(std::hash<FixedBitset<2>>{}(fixed) == std::hash<Bitset>{}(wide));
+        REQUIRE(bitset_cast<Bitset>(fixed) == wide);
+        REQUIRE(bitset_cast<FixedBitset<4>>(wide) == FixedBitset<4>::fromWords(fixed.data(), 2));
+    }
+
+    SECTION("dispatch by width") {
+        auto numWords = [](size_t numBits) {
+            return dispatchByWidth(numBits, [](auto bitsetType) {
+                using BitsetT = typename decltype(bitsetType)::type;
+                if constexpr (std::is_same_v<BitsetT, Bitset>) {
+                    return size_t{0};
+                } else {
+                    return BitsetT::numWords();
+                }
+            });
+        };
+        REQUIRE(numWords(0) == 1);
+        REQUIRE(numWords(64) == 1);
+        REQUIRE(numWords(65) == 2);
+        REQUIRE(numWords(129) == 4);
+        REQUIRE(numWords(256) == 4);
+        REQUIRE(numWords(257) == 0);
+    }
+
+    SECTION("(A | B) & (C | ~D) with 2-word minterms") {
+        using Minterm2 = BasicMinterm<FixedBitset<2>>;
+        using Maxterm2 = BasicMaxterm<FixedBitset<2>>;
+        Maxterm2 a_b{Minterm2(0, true), Minterm2(70, true)};
+        Maxterm2 c_nd{Minterm2(100, true), Minterm2(0, false)};
+
+        Minterm2 ac(0, true);
+        ac.set(100, true);
+        Minterm2 bc(70, true);
+        bc.set(100, true);
+        Minterm2 bnd(70, true);
+        bnd.set(0, false);
+        Maxterm2 expectedResult{ac, bc, bnd};
+
+        auto result = a_b & c_nd;
+        REQUIRE(expectedResult == result);
+        REQUIRE(maxterm_cast<Bitset>(result) == maxterm_cast<Bitset>(expectedResult));
+    }
+}
+
 TEST_CASE("Minterm operations") {
     SECTION("a & b") {
         Minterm a{"01", "01"};
@@ -77,6 +169,21 @@ TEST_CASE("Minterm operations") {
 }
 
 TEST_CASE("Maxterm operation") {
+    SECTION("(A | B) & C with 100 predicates") {
+        Maxterm a_b{Minterm(0, true), Minterm(99, true)};
+        Maxterm c{Minterm(64, false)};
+
+        Minterm ac(0, true);
+        ac.set(64, false);
+        Minterm bc(99, true);
+        bc.set(64, false);
+        Maxterm expectedResult{ac, bc};
+
+        auto result = a_b & c;
+        REQUIRE(expectedResult == result);
+    }
+
+
     SECTION("AB |= c") {
         Maxterm ab{{"011", "011"}};
         Minterm c{"100", "100"};
@@ -0,0 +1,180 @@
+#include "predicate_optimizer/columnar_maxterm.h"
+#include "predicate_optimizer/cpu_features.h"
+
+#include <bit>
+
+namespace predicate_optimizer {
+namespace {
+// Number of right minterms tested at once, 4 64-bit lanes of an AVX2 register.
+constexpr size_t kBlockSize = 4;
+
+// Products with fewer right minterms are not worth transposing.
+constexpr size_t kMinColumnarSize = 2 * kBlockSize;
+
+// Return the bitmask of minterms in [begin, end) of the right maxterm which do not conflict with
+// the left minterm.
+template <size_t NumWords>
+unsigned survivorsScalar(const BasicMinterm<FixedBitset<NumWords>>& left,
+                         const ColumnarMaxterm<NumWords>& right,
+                         size_t begin,
+                         size_t end) {
+    unsigned survivors = 0;
+    for (size_t j = begin; j < end; ++j) {
+        Bitset::Word conflicts = 0;
+        for (size_t w = 0; w < NumWords; ++w) {
+            conflicts |= (left.bitset.data()[w] ^ right.bitsets[w][j]) &
+                (left.mask.data()[w] & right.masks[w][j]);
+        }
+        survivors |= static_cast<unsigned>(conflicts == 0) << (j - begin);
+    }
+    return survivors;
+}
+
+#ifdef PREDICATE_OPTIMIZER_HAS_AVX2_KERNEL
+template <size_t NumWords>
+__attribute__((target("avx2"))) unsigned survivorsAvx2(
+    const BasicMinterm<FixedBitset<NumWords>>& left,
+    const ColumnarMaxterm<NumWords>& right,
+    size_t begin) {
+    __m256i conflicts = _mm256_setzero_si256();
+    for (size_t w = 0; w < NumWords; ++w) {
+        const __m256i leftBits = _mm256_set1_epi64x(left.bitset.data()[w]);
+        const __m256i leftMask = _mm256_set1_epi64x(left.mask.data()[w]);
+        const __m256i rightBits =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right.bitsets[w].data() + begin));
+        const __m256i rightMask =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right.masks[w].data() + begin));
+        conflicts = _mm256_or_si256(
+            conflicts,
+            _mm256_and_si256(_mm256_xor_si256(leftBits, rightBits),
+                             _mm256_and_si256(leftMask, rightMask)));
+    }
+    const __m256i isZero = _mm256_cmpeq_epi64(conflicts, _mm256_setzero_si256());
+    return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(isZero)));
+}
+#endif
+
+template <size_t NumWords>
+void appendProducts(const BasicMinterm<FixedBitset<NumWords>>& left,
+                    const ColumnarMaxterm<NumWords>& right,
+                    size_t begin,
+                    unsigned survivors,
+                    BasicMaxterm<FixedBitset<NumWords>>& result) {
+    while (survivors != 0) {
+        const size_t j = begin + std::countr_zero(survivors);
+        survivors &= survivors - 1;
+
+        auto& product = result.minterms.emplace_back(left);
+        for (size_t w = 0; w < NumWords; ++w) {
+            product.bitset.data()[w] |= right.bitsets[w][j];
+            product.mask.data()[w] |= right.masks[w][j];
+        }
+    }
+}
+
+template <size_t NumWords>
+BasicMaxterm<FixedBitset<NumWords>> conjunctionImpl(const BasicMaxterm<FixedBitset<NumWords>>& lhs,
+                                                    const ColumnarMaxterm<NumWords>& rhs,
+                                                    bool useAvx2) {
+    BasicMaxterm<FixedBitset<NumWords>> result{};
+    result.minterms.reserve(lhs.minterms.size() * rhs.size());
+
+    const size_t numBlocks = rhs.size() / kBlockSize;
+    for (const auto& left : lhs.minterms) {
+        for (size_t block = 0; block < numBlocks; ++block) {
+            const size_t begin = block * kBlockSize;
+#ifdef PREDICATE_OPTIMIZER_HAS_AVX2_KERNEL
+            const unsigned survivors = useAvx2
+                ? survivorsAvx2(left, rhs, begin)
+                : survivorsScalar(left, rhs, begin, begin + kBlockSize);
+#else
+            const unsigned survivors = survivorsScalar(left, rhs, begin, begin + kBlockSize);
+#endif
+            appendProducts(left, rhs, begin, survivors, result);
+        }
+
+        const size_t tail = numBlocks * kBlockSize;
+        appendProducts(left, rhs, tail, survivorsScalar(left, rhs, tail, rhs.size()), result);
+    }
+
+    return result;
+}
+}  // namespace
+
+template <size_t NumWords>
+ColumnarMaxterm<NumWords>::ColumnarMaxterm(const MaxtermType& maxterm) {
+    for (size_t w = 0; w < NumWords; ++w) {
+        bitsets[w].reserve(maxterm.minterms.size());
+        masks[w].reserve(maxterm.minterms.size());
+    }
+    for (const auto& minterm : maxterm.minterms) {
+        push_back(minterm);
+    }
+}
+
+template <size_t NumWords>
+void ColumnarMaxterm<NumWords>::push_back(const MintermType& minterm) {
+    for (size_t w = 0; w < NumWords; ++w) {
+        bitsets[w].push_back(minterm.bitset.data()[w]);
+        masks[w].push_back(minterm.mask.data()[w]);
+    }
+}
+
+template <size_t NumWords>
+typename ColumnarMaxterm<NumWords>::MintermType ColumnarMaxterm<NumWords>::operator[](
+    size_t index) const {
+    MintermType minterm{};
+    for (size_t w = 0; w < NumWords; ++w) {
+        minterm.bitset.data()[w] = bitsets[w][index];
+        minterm.mask.data()[w] = masks[w][index];
+    }
+    return minterm;
+}
+
+template <size_t NumWords>
+typename ColumnarMaxterm<NumWords>::MaxtermType ColumnarMaxterm<NumWords>::toMaxterm() const {
+    MaxtermType result{};
+    result.minterms.reserve(size());
+    for (size_t i = 0; i < size(); ++i) {
+        result.minterms.emplace_back((*this)[i]);
+    }
+    return result;
+}
+
+template <size_t NumWords>
+BasicMaxterm<FixedBitset<NumWords>> conjunction(const BasicMaxterm<FixedBitset<NumWords>>& lhs,
+                                                const ColumnarMaxterm<NumWords>& rhs) {
+#ifdef PREDICATE_OPTIMIZER_HAS_AVX2_KERNEL
+    return conjunctionImpl(lhs, rhs, hasAvx2());
+#else
+    return conjunctionImpl(lhs, rhs, false);
+#endif
+}
+
+template <size_t NumWords>
+BasicMaxterm<FixedBitset<NumWords>> operator&(const BasicMaxterm<FixedBitset<NumWords>>& lhs,
+                                              const BasicMaxterm<FixedBitset<NumWords>>& rhs) {
+    if (rhs.minterms.size() < kMinColumnarSize) {
+        return detail::rowWiseProduct(lhs, rhs);
+    }
+    return conjunction(lhs, ColumnarMaxterm<NumWords>{rhs});
+}
+
+template struct ColumnarMaxterm<1>;
+template struct ColumnarMaxterm<2>;
+template struct ColumnarMaxterm<4>;
+
+template BasicMaxterm<FixedBitset<1>> conjunction(const BasicMaxterm<FixedBitset<1>>&,
+                                                  const ColumnarMaxterm<1>&);
+template BasicMaxterm<FixedBitset<2>> conjunction(const BasicMaxterm<FixedBitset<2>>&,
+                                                  const ColumnarMaxterm<2>&);
+template BasicMaxterm<FixedBitset<4>> conjunction(const BasicMaxterm<FixedBitset<4>>&,
+                                                  const ColumnarMaxterm<4>&);
+
+template BasicMaxterm<FixedBitset<1>> operator&(const BasicMaxterm<FixedBitset<1>>&,
+                                                const BasicMaxterm<FixedBitset<1>>&);
+template BasicMaxterm<FixedBitset<2>> operator&(const BasicMaxterm<FixedBitset<2>>&,
+                                                const BasicMaxterm<FixedBitset<2>>&);
+template BasicMaxterm<FixedBitset<4>> operator&(const BasicMaxterm<FixedBitset<4>>&,
+                                                const BasicMaxterm<FixedBitset<4>>&);
+}  // namespace predicate_optimizer
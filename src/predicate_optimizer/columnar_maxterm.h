@@ -0,0 +1,46 @@
+#pragma once
+
+#include "predicate_optimizer/bitset_algebra.h"
+#include <array>
+#include <vector>
+
+namespace predicate_optimizer {
+/**
+ * Structure-of-arrays layout of a Maxterm of fixed width minterms: the word w of the bitsets and of
+ * the masks of all minterms is stored in the contiguous columns bitsets[w] and masks[w]. It lets
+ * the conjunction kernel test one minterm against several minterms of the columnar side at once.
+ */
+template <size_t NumWords>
+struct ColumnarMaxterm {
+    using Word = Bitset::Word;
+    using MintermType = BasicMinterm<FixedBitset<NumWords>>;
+    using MaxtermType = BasicMaxterm<FixedBitset<NumWords>>;
+
+    ColumnarMaxterm() {}
+    explicit ColumnarMaxterm(const MaxtermType& maxterm);
+
+    size_t size() const {
+        return bitsets[0].size();
+    }
+
+    void push_back(const MintermType& minterm);
+    MintermType operator[](size_t index) const;
+    MaxtermType toMaxterm() const;
+
+    std::array<std::vector<Word>, NumWords> bitsets;
+    std::array<std::vector<Word>, NumWords> masks;
+};
+
+/**
+ * Conjunction of the maxterms, the products of conflicting minterms are dropped. The result
+ * preserves the order of the row-wise product: for every left minterm, the right minterms in order.
+ * Uses AVX2 when the CPU supports it, a scalar loop otherwise.
+ */
+template <size_t NumWords>
+BasicMaxterm<FixedBitset<NumWords>> conjunction(const BasicMaxterm<FixedBitset<NumWords>>& lhs,
+                                                const ColumnarMaxterm<NumWords>& rhs);
+
+extern template struct ColumnarMaxterm<1>;
+extern template struct ColumnarMaxterm<2>;
+extern template struct ColumnarMaxterm<4>;
+}  // namespace predicate_optimizer
@@ -0,0 +1,49 @@
+#include "Catch2/catch_amalgamated.hpp"
+#include "predicate_optimizer/columnar_maxterm.h"
+
+namespace predicate_optimizer {
+TEST_CASE("Columnar Maxterm") {
+    using Minterm1 = BasicMinterm<FixedBitset<1>>;
+    using Maxterm1 = BasicMaxterm<FixedBitset<1>>;
+
+    SECTION("round trip") {
+        Maxterm1 maxterm{{"011", "011"}, {"100", "110"}, {"000", "001"}};
+        ColumnarMaxterm<1> columnar{maxterm};
+
+        REQUIRE(columnar.size() == 3);
+        REQUIRE(columnar[1] == Minterm1{"100", "110"});
+        REQUIRE(columnar.toMaxterm() == maxterm);
+    }
+
+    SECTION("(A | B) & (C0 | ... | C9 | ~A)") {
+        Maxterm1 a_b{Minterm1(0, true), Minterm1(1, true)};
+        Maxterm1 rhs{};
+        for (size_t i = 2; i < 12; ++i) {
+            rhs.minterms.emplace_back(i, true);
+        }
+        rhs.minterms.emplace_back(0, false);
+
+        auto expectedResult = detail::rowWiseProduct(a_b, rhs);
+        REQUIRE(expectedResult.minterms.size() == 21);
+
+        REQUIRE(conjunction(a_b, ColumnarMaxterm<1>{rhs}) == expectedResult);
+        REQUIRE((a_b & rhs) == expectedResult);
+    }
+
+    SECTION("4-word conflicts in the high words") {
+        using Minterm4 = BasicMinterm<FixedBitset<4>>;
+        using Maxterm4 = BasicMaxterm<FixedBitset<4>>;
+
+        Maxterm4 lhs{Minterm4(200, true), Minterm4(3, false)};
+        Maxterm4 rhs{};
+        for (size_t i = 0; i < 9; ++i) {
+            rhs.minterms.emplace_back(190 + i * 2, i % 2 == 0);
+            rhs.minterms.emplace_back(3, true);
+        }
+
+        auto expectedResult = detail::rowWiseProduct(lhs, rhs);
+        REQUIRE(conjunction(lhs, ColumnarMaxterm<4>{rhs}) == expectedResult);
+        REQUIRE((lhs & rhs) == expectedResult);
+    }
+}
+}  // namespace predicate_optimizer
@@ -0,0 +1,536 @@
+#include "predicate_optimizer/compiled_filter.h"
+#include "predicate_optimizer/cpu_features.h"
+#include "predicate_optimizer/expression_dnf.h"
+#include "predicate_optimizer/expression_rewrite.h"
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <stdexcept>
+
+namespace predicate_optimizer {
+namespace {
+bool lessTyped(const TypedValue* lhs, const TypedValue* rhs) {
+    return *lhs < *rhs;
+}
+
+struct PredicateCompiler {
+    void operator()(const Expression&, const ComparisonExpression& expr) {
+        predicate.kind = CompiledPredicate::Kind::Comparison;
+        switch (expr.op) {
+            case ComparisonOperator::EQ:
+                [[fallthrough]];
+            case ComparisonOperator::GE:
+                [[fallthrough]];
+            case ComparisonOperator::GT:
+                predicate.comparisonOp = expr.op;
+                break;
+            case ComparisonOperator::LE:
+                [[fallthrough]];
+            case ComparisonOperator::LT:
+                [[fallthrough]];
+            case ComparisonOperator::NE:
+                predicate.comparisonOp = negate(expr.op);
+                predicate.isNegated = true;
+                break;
+        }
+        predicate.path = expr.path;
+        predicate.values.emplace_back(expr.value);
+    }
+
+    void operator()(const Expression&, const InExpression& expr) {
+        predicate.kind = CompiledPredicate::Kind::In;
+        predicate.isNegated = expr.op == InOperator::NotIn;
+        predicate.path = expr.path;
+        predicate.values = expr.values;
+        if (expr.values.size() >= CompiledPredicate::kMinIndexedValues) {
+            predicate.valueSet.insert(begin(expr.values), end(expr.values));
+            predicate.typedValues.reserve(expr.values.size());
+            for (const auto& value : expr.values) {
+                predicate.typedValues.push_back(&value.typed());
+            }
+            std::sort(begin(predicate.typedValues), end(predicate.typedValues), lessTyped);
+        }
+    }
+
+    template <typename E>
+    void operator()(const Expression&, const E&) {
+        throw std::runtime_error("Only comparisons and $in can be compiled to predicates");
+    }
+
+    CompiledPredicate& predicate;
+};
+
+// Result of the positive comparison operator for the given ordering of the value and the operand.
+bool compare(ComparisonOperator op, std::weak_ordering cmp) {
+    switch (op) {
+        case ComparisonOperator::EQ:
+            return cmp == 0;
+        case ComparisonOperator::GE:
+            return cmp >= 0;
+        case ComparisonOperator::GT:
+            return cmp > 0;
+        case ComparisonOperator::LE:
+            [[fallthrough]];
+        case ComparisonOperator::LT:
+            [[fallthrough]];
+        case ComparisonOperator::NE:
+            throw std::runtime_error("Unexpected negative comparison operator");
+    }
+    __builtin_unreachable();
+}
+
+// Mask of the valid bits of the last word of a bitmap of numRows bits.
+Bitset::Word lastWordMask(size_t numRows) {
+    const size_t numTailBits = numRows % Bitset::kWordBits;
+    if (numTailBits == 0 && numRows != 0) {
+        return ~Bitset::Word{0};
+    }
+    return (Bitset::Word{1} << numTailBits) - 1;
+}
+
+// Set the bits of the rows whose value satisfies the function, 64 rows per word. This is the
+// evaluation of $in and of the comparisons of Mixed columns, a value is parsed per row.
+template <typename Function>
+void fillBits(const std::vector<Value>& values,
+              size_t numRows,
+              Bitset::Word* bits,
+              Function&& function) {
+    for (size_t w = 0; w < Bitset::wordsFor(numRows); ++w) {
+        const size_t begin = w * Bitset::kWordBits;
+        const size_t end = std::min(begin + Bitset::kWordBits, numRows);
+        Bitset::Word word = 0;
+        for (size_t r = begin; r < end; ++r) {
+            word |= Bitset::Word{function(values[r])} << (r - begin);
+        }
+        bits[w] = word;
+    }
+}
+
+// Return the word of the bitset, the words beyond its storage are zeros.
+Bitset::Word wordAt(const Bitset& bitset, size_t index) {
+    return index < bitset.numWords() ? bitset.data()[index] : 0;
+}
+
+template <ComparisonOperator Op, typename T>
+bool compareValue(T value, T operand) {
+    if constexpr (Op == ComparisonOperator::EQ) {
+        return value == operand;
+    } else if constexpr (Op == ComparisonOperator::GE) {
+        return value >= operand;
+    } else {
+        static_assert(Op == ComparisonOperator::GT);
+        return value > operand;
+    }
+}
+
+// Bits of the comparisons of the first numRows values with the operand, at most 64 rows.
+template <ComparisonOperator Op, typename T>
+Bitset::Word compareWordScalar(const T* values, size_t numRows, T operand) {
+    Bitset::Word word = 0;
+    for (size_t r = 0; r < numRows; ++r) {
+        word |= Bitset::Word{compareValue<Op>(values[r], operand)} << r;
+    }
+    return word;
+}
+
+#ifdef PREDICATE_OPTIMIZER_HAS_AVX2_KERNEL
+// Compare numWords words of 64 values with the operand, 4 values per instruction. Integers have no
+// GE instruction, a >= b is the complement of b > a.
+template <ComparisonOperator Op>
+__attribute__((target("avx2"))) void compareWordsAvx2(const int64_t* values,
+                                                      size_t numWords,
+                                                      int64_t operand,
+                                                      Bitset::Word* bits) {
+    const __m256i rhs = _mm256_set1_epi64x(operand);
+    for (size_t w = 0; w < numWords; ++w, values += Bitset::kWordBits) {
+        Bitset::Word word = 0;
+        for (size_t i = 0; i < Bitset::kWordBits; i += 4) {
+            const __m256i lhs = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+            __m256i result{};
+            if constexpr (Op == ComparisonOperator::EQ) {
+                result = _mm256_cmpeq_epi64(lhs, rhs);
+            } else if constexpr (Op == ComparisonOperator::GE) {
+                result = _mm256_xor_si256(_mm256_cmpgt_epi64(rhs, lhs), _mm256_set1_epi64x(-1));
+            } else {
+                result = _mm256_cmpgt_epi64(lhs, rhs);
+            }
+            const auto mask =
+                static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(result)));
+            word |= Bitset::Word{mask} << i;
+        }
+        bits[w] = word;
+    }
+}
+
+template <ComparisonOperator Op>
+__attribute__((target("avx2"))) void compareWordsAvx2(const double* values,
+                                                      size_t numWords,
+                                                      double operand,
+                                                      Bitset::Word* bits) {
+    const __m256d rhs = _mm256_set1_pd(operand);
+    for (size_t w = 0; w < numWords; ++w, values += Bitset::kWordBits) {
+        Bitset::Word word = 0;
+        for (size_t i = 0; i < Bitset::kWordBits; i += 4) {
+            const __m256d lhs = _mm256_loadu_pd(values + i);
+            __m256d result{};
+            if constexpr (Op == ComparisonOperator::EQ) {
+                result = _mm256_cmp_pd(lhs, rhs, _CMP_EQ_OQ);
+            } else if constexpr (Op == ComparisonOperator::GE) {
+                result = _mm256_cmp_pd(lhs, rhs, _CMP_GE_OQ);
+            } else {
+                result = _mm256_cmp_pd(lhs, rhs, _CMP_GT_OQ);
+            }
+            word |= Bitset::Word{static_cast<unsigned>(_mm256_movemask_pd(result))} << i;
+        }
+        bits[w] = word;
+    }
+}
+#endif
+
+// Compare the first numRows values with the operand into the words of a bitmap of numRows bits.
+// The full words are compared by the AVX2 kernel if the CPU supports it, the last partial word by
+// the scalar loop.
+template <ComparisonOperator Op, typename T>
+void compareColumn(const T* values, size_t numRows, T operand, Bitset::Word* bits) {
+    const size_t numFullWords = numRows / Bitset::kWordBits;
+    size_t w = 0;
+#ifdef PREDICATE_OPTIMIZER_HAS_AVX2_KERNEL
+    if (hasAvx2()) {
+        compareWordsAvx2<Op>(values, numFullWords, operand, bits);
+        w = numFullWords;
+    }
+#endif
+    for (; w < numFullWords; ++w) {
+        bits[w] = compareWordScalar<Op>(values + w * Bitset::kWordBits, Bitset::kWordBits, operand);
+    }
+    if (numRows % Bitset::kWordBits != 0 || numRows == 0) {
+        bits[w] = compareWordScalar<Op>(
+            values + w * Bitset::kWordBits, numRows % Bitset::kWordBits, operand);
+    }
+}
+
+template <typename T>
+void compareColumn(
+    const T* values, size_t numRows, ComparisonOperator op, T operand, Bitset::Word* bits) {
+    switch (op) {
+        case ComparisonOperator::EQ:
+            return compareColumn<ComparisonOperator::EQ>(values, numRows, operand, bits);
+        case ComparisonOperator::GE:
+            return compareColumn<ComparisonOperator::GE>(values, numRows, operand, bits);
+        case ComparisonOperator::GT:
+            return compareColumn<ComparisonOperator::GT>(values, numRows, operand, bits);
+        case ComparisonOperator::LE:
+            [[fallthrough]];
+        case ComparisonOperator::LT:
+            [[fallthrough]];
+        case ComparisonOperator::NE:
+            throw std::runtime_error("Unexpected negative comparison operator");
+    }
+}
+
+// Compare the typed values of the column with the operand, return false if the types of the column
+// and of the operand differ. Numbers of different types compare exactly in TypedValue, which no
+// kernel does.
+bool compareTyped(const TypedColumn& column,
+                  ComparisonOperator op,
+                  const TypedValue& operand,
+                  size_t numRows,
+                  Bitset::Word* bits) {
+    switch (column.type) {
+        case TypedColumn::Type::Int64:
+            if (operand.type() != TypedValue::Type::Int64) {
+                return false;
+            }
+            compareColumn(column.ints.data(), numRows, op, operand.int64(), bits);
+            return true;
+        case TypedColumn::Type::Double:
+            if (operand.type() != TypedValue::Type::Double) {
+                return false;
+            }
+            compareColumn(column.doubles.data(), numRows, op, operand.toDouble(), bits);
+            return true;
+        case TypedColumn::Type::Date:
+            if (operand.type() != TypedValue::Type::Date) {
+                return false;
+            }
+            compareColumn(column.ints.data(), numRows, op, operand.millisSinceEpoch(), bits);
+            return true;
+        case TypedColumn::Type::Mixed:
+            return false;
+    }
+    __builtin_unreachable();
+}
+
+TypedColumn::Type columnType(TypedValue::Type type) {
+    switch (type) {
+        case TypedValue::Type::Int64:
+            return TypedColumn::Type::Int64;
+        case TypedValue::Type::Double:
+            return TypedColumn::Type::Double;
+        case TypedValue::Type::Date:
+            return TypedColumn::Type::Date;
+        case TypedValue::Type::Decimal:
+            [[fallthrough]];
+        case TypedValue::Type::String:
+            return TypedColumn::Type::Mixed;
+    }
+    __builtin_unreachable();
+}
+}  // namespace
+
+TypedColumn::TypedColumn(const Column& column, size_t numRows) {
+    bool isFirst = true;
+    const size_t numWords = Bitset::wordsFor(numRows);
+    for (size_t w = 0; w < numWords; ++w) {
+        Bitset::Word present = wordAt(column.present, w);
+        if (w + 1 == numWords) {
+            present &= lastWordMask(numRows);
+        }
+        for (; present != 0; present &= present - 1) {
+            const size_t r = w * Bitset::kWordBits + std::countr_zero(present);
+            const auto& value = column.values[r].typed();
+            const auto valueType = columnType(value.type());
+            if (isFirst) {
+                isFirst = false;
+                type = valueType;
+                if (type == Type::Mixed) {
+                    return;
+                }
+                if (type == Type::Double) {
+                    doubles.resize(numRows);
+                } else {
+                    ints.resize(numRows);
+                }
+            } else if (valueType != type) {
+                type = Type::Mixed;
+                ints = {};
+                doubles = {};
+                return;
+            }
+
+            if (type == Type::Double) {
+                doubles[r] = value.toDouble();
+            } else {
+                ints[r] = value.int64();
+            }
+        }
+    }
+}
+
+CompiledPredicate::CompiledPredicate(const Expression& expr) {
+    expr.visit(PredicateCompiler{*this});
+}
+
+bool CompiledPredicate::evaluate(const Value* value) const {
+    bool result = false;
+    if (value != nullptr) {
+        switch (kind) {
+            case Kind::Comparison:
+                result = compare(comparisonOp, value->typed() <=> values.front().typed());
+                break;
+            case Kind::In:
+                result = isIn(*value);
+                break;
+        }
+    }
+    return result != isNegated;
+}
+
+void CompiledPredicate::evaluate(const Column* column, size_t numRows, Bitset::Word* bits) const {
+    if (column != nullptr && kind == Kind::Comparison) {
+        const TypedColumn typed{*column, numRows};
+        evaluate(column, &typed, numRows, bits);
+    } else {
+        evaluate(column, nullptr, numRows, bits);
+    }
+}
+
+void CompiledPredicate::evaluate(const Column* column,
+                                 const TypedColumn* typed,
+                                 size_t numRows,
+                                 Bitset::Word* bits) const {
+    const size_t numWords = Bitset::wordsFor(numRows);
+    if (column == nullptr) {
+        std::fill(bits, bits + numWords, 0);
+    } else {
+        switch (kind) {
+            case Kind::Comparison: {
+                const auto& operand = values.front();
+                if (typed != nullptr &&
+                    compareTyped(*typed, comparisonOp, operand.typed(), numRows, bits)) {
+                    break;
+                }
+                switch (comparisonOp) {
+                    case ComparisonOperator::EQ:
+                        fillBits(column->values, numRows, bits, [&](const Value& value) {
+                            return value == operand || value.typed() == operand.typed();
+                        });
+                        break;
+                    case ComparisonOperator::GE:
+                        fillBits(column->values, numRows, bits, [&](const Value& value) {
+                            return value.typed() >= operand.typed();
+                        });
+                        break;
+                    case ComparisonOperator::GT:
+                        fillBits(column->values, numRows, bits, [&](const Value& value) {
+                            return value.typed() > operand.typed();
+                        });
+                        break;
+                    case ComparisonOperator::LE:
+                        [[fallthrough]];
+                    case ComparisonOperator::LT:
+                        [[fallthrough]];
+                    case ComparisonOperator::NE:
+                        throw std::runtime_error("Unexpected negative comparison operator");
+                }
+                break;
+            }
+            case Kind::In:
+                fillBits(column->values, numRows, bits, [&](const Value& value) {
+                    return isIn(value);
+                });
+                break;
+        }
+
+        for (size_t w = 0; w < numWords; ++w) {
+            bits[w] &= wordAt(column->present, w);
+        }
+    }
+
+    if (isNegated) {
+        for (size_t w = 0; w < numWords; ++w) {
+            bits[w] = ~bits[w];
+        }
+        bits[numWords - 1] &= lastWordMask(numRows);
+    }
+}
+
+bool CompiledPredicate::isIn(const Value& value) const {
+    if (typedValues.empty()) {
+        return std::any_of(begin(values), end(values), [&](const Value& operand) {
+            return value == operand || value.typed() == operand.typed();
+        });
+    }
+
+    if (valueSet.contains(value)) {
+        return true;
+    }
+    // A string is equal to the same string only.
+    if (value.typed().type() == TypedValue::Type::String) {
+        return false;
+    }
+    return std::binary_search(begin(typedValues), end(typedValues), &value.typed(), lessTyped);
+}
+
+CompiledFilter::CompiledFilter(const Expression& expr, const NormalFormOptions& options)
+    : CompiledFilter(transformToNormalForm(removeNotExpressions(expr), options)) {}
+
+CompiledFilter::CompiledFilter(const std::pair<Maxterm, std::vector<Expression>>& normalForm)
+    : CompiledFilter(normalForm.first, normalForm.second) {}
+
+CompiledFilter::CompiledFilter(const Maxterm& maxterm, const std::vector<Expression>& expressions)
+    : _numWords(Bitset::wordsFor(expressions.size())), _numMinterms(maxterm.minterms.size()) {
+    _predicates.reserve(expressions.size());
+    for (const auto& expr : expressions) {
+        _predicates.emplace_back(expr);
+    }
+
+    _minterms.reserve(2 * _numWords * _numMinterms);
+    for (const auto& minterm : maxterm.minterms) {
+        for (size_t w = 0; w < _numWords; ++w) {
+            _minterms.push_back(wordAt(minterm.bitset, w));
+        }
+        for (size_t w = 0; w < _numWords; ++w) {
+            _minterms.push_back(wordAt(minterm.mask, w));
+        }
+    }
+}
+
+bool CompiledFilter::matches(const Document& document) const {
+    return matchesPredicates(evaluatePredicates(document));
+}
+
+Bitset CompiledFilter::evaluatePredicates(const Document& document) const {
+    auto bits = Bitset::zeros(_predicates.size());
+    for (size_t i = 0; i < _predicates.size(); ++i) {
+        const auto& predicate = _predicates[i];
+        auto pos = document.find(predicate.path);
+        if (predicate.evaluate(pos != document.end() ? &pos->second : nullptr)) {
+            bits.set(i);
+        }
+    }
+    return bits;
+}
+
+bool CompiledFilter::matchesPredicates(const Bitset& bits) const {
+    const Bitset::Word* minterm = _minterms.data();
+    for (size_t m = 0; m < _numMinterms; ++m, minterm += 2 * _numWords) {
+        bool isMatch = true;
+        for (size_t w = 0; w < _numWords && isMatch; ++w) {
+            isMatch = ((wordAt(bits, w) ^ minterm[w]) & minterm[_numWords + w]) == 0;
+        }
+        if (isMatch) {
+            return true;
+        }
+    }
+    return false;
+}
+
+Bitset CompiledFilter::select(const RecordBatch& batch) const {
+    const size_t numRows = batch.numRows;
+    const size_t numRowWords = Bitset::wordsFor(numRows);
+
+    // The columns of the comparisons are parsed once, on the first comparison of their paths.
+    std::unordered_map<Path, TypedColumn> typedColumns{};
+    std::vector<Bitset::Word> predicateBits(_predicates.size() * numRowWords);
+    for (size_t i = 0; i < _predicates.size(); ++i) {
+        const auto& predicate = _predicates[i];
+        auto pos = batch.columns.find(predicate.path);
+        const Column* column = pos != batch.columns.end() ? &pos->second : nullptr;
+        const TypedColumn* typed = nullptr;
+        if (column != nullptr && predicate.kind == CompiledPredicate::Kind::Comparison) {
+            typed = &typedColumns.try_emplace(predicate.path, *column, numRows).first->second;
+        }
+        predicate.evaluate(column, typed, numRows, predicateBits.data() + i * numRowWords);
+    }
+
+    auto selection = Bitset::zeros(numRows);
+    Bitset::Word* selectionWords = selection.data();
+    std::vector<Bitset::Word> mintermBits(numRowWords);
+    const Bitset::Word* minterm = _minterms.data();
+    for (size_t m = 0; m < _numMinterms; ++m, minterm += 2 * _numWords) {
+        std::fill(begin(mintermBits), end(mintermBits), ~Bitset::Word{0});
+        for (size_t w = 0; w < _numWords; ++w) {
+            for (Bitset::Word mask = minterm[_numWords + w]; mask != 0; mask &= mask - 1) {
+                const size_t bit = std::countr_zero(mask);
+                const Bitset::Word* bits =
+                    predicateBits.data() + (w * Bitset::kWordBits + bit) * numRowWords;
+                if ((minterm[w] >> bit) & 1) {
+                    for (size_t r = 0; r < numRowWords; ++r) {
+                        mintermBits[r] &= bits[r];
+                    }
+                } else {
+                    for (size_t r = 0; r < numRowWords; ++r) {
+                        mintermBits[r] &= ~bits[r];
+                    }
+                }
+            }
+        }
+
+        for (size_t r = 0; r < numRowWords; ++r) {
+            selectionWords[r] |= mintermBits[r];
+        }
+    }
+    selectionWords[numRowWords - 1] &= lastWordMask(numRows);
+    return selection;
+}
+
+CompileResult tryCompileFilter(const Expression& expr, const NormalFormOptions& options) {
+    auto normalForm = tryTransformToNormalForm(removeNotExpressions(expr), options);
+    if (normalForm.status != ExpansionStatus::Ok) {
+        return {normalForm.status, std::nullopt};
+    }
+    return {ExpansionStatus::Ok, CompiledFilter{normalForm.maxterm, normalForm.expressions}};
+}
+}  // namespace predicate_optimizer
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "predicate_optimizer/bitset_algebra.h"
+#include "predicate_optimizer/expansion_budget.h"
+#include "predicate_optimizer/expression.h"
+#include "predicate_optimizer/expression_dnf.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace predicate_optimizer {
+// Values of the paths of a document, a missing path has no value.
+using Document = std::unordered_map<Path, Value>;
+
+// Values of one path in a batch of records.
+struct Column {
+    // Value of every row of the batch, the values of the rows where the path is missing are
+    // ignored.
+    std::vector<Value> values;
+    // The bit r is set if the row r has a value.
+    Bitset present;
+};
+
+/**
+ * Values of a column parsed once per batch into one array of their common type, and shared by the
+ * comparisons of the path. A typed column is compared with an operand of the same type by vector
+ * kernels. Columns of decimals or strings, and columns mixing types, are Mixed and are compared
+ * value by value.
+ */
+struct TypedColumn {
+    enum class Type : uint8_t { Int64, Double, Date, Mixed };
+
+    // Parse the present values of the first numRows rows of the column.
+    TypedColumn(const Column& column, size_t numRows);
+
+    Type type{Type::Mixed};
+    // Values of an Int64 column, or milliseconds since the Unix epoch of a Date column, zeros in
+    // the missing rows.
+    std::vector<int64_t> ints;
+    // Values of a Double column, zeros in the missing rows.
+    std::vector<double> doubles;
+};
+
+// Batch of records in columnar form, a path without a column is missing in every row.
+struct RecordBatch {
+    size_t numRows{0};
+    std::unordered_map<Path, Column> columns;
+};
+
+/**
+ * Leaf predicate of a compiled filter. A predicate on a missing path is false for EQ, GE, GT and
+ * $in, and true for the negated operators NE, LT, LE and $nin, the same semantics as the cleared
+ * bits of the normal form. Values are compared by their parsed types, see TypedValue.
+ */
+struct CompiledPredicate {
+    enum class Kind { Comparison, In };
+
+    // Smallest number of values of a $in tested through valueSet and typedValues instead of a
+    // linear scan.
+    static constexpr size_t kMinIndexedValues = 32;
+
+    explicit CompiledPredicate(const Expression& expr);
+
+    bool evaluate(const Value* value) const;
+
+    // Evaluate the predicate on every row of the column into the words of a bitmap of numRows
+    // bits, a null column is missing in every row.
+    void evaluate(const Column* column, size_t numRows, Bitset::Word* bits) const;
+
+    // Same as above with the typed values of the column parsed by the caller, null for a missing
+    // column or a $in.
+    void evaluate(const Column* column,
+                  const TypedColumn* typed,
+                  size_t numRows,
+                  Bitset::Word* bits) const;
+
+    // Return true if the value is equal to one of the values of the $in.
+    bool isIn(const Value& value) const;
+
+    Kind kind;
+    // Operator of the positive form of the predicate, and whether the predicate is its negation.
+    ComparisonOperator comparisonOp{ComparisonOperator::EQ};
+    bool isNegated{false};
+    Path path;
+    // The value of a comparison, or the values of $in.
+    std::vector<Value> values;
+    // The values of a $in of at least kMinIndexedValues values, empty otherwise. A value is found
+    // in the hash set if it is spelled the same as an operand, and in the values sorted by their
+    // parsed types otherwise, e.g. 1.0 and 1.
+    std::unordered_set<Value> valueSet;
+    std::vector<const TypedValue*> typedValues;
+};
+
+/* Options of the normal form of a compiled expression: the unsatisfiable minterms are pruned, and
+ * the expansion is limited, a filter of millions of minterms is slower than the expression.*/
+inline constexpr NormalFormOptions kCompileOptions{
+    .pruneContradictions = true,
+    .budget = {.maxMinterms = size_t{1} << 16, .maxBytes = size_t{64} << 20},
+};
+
+/**
+ * Filter compiled from a normal form. Every distinct leaf predicate is evaluated once per document
+ * into a bitset, then the minterms are tested by a few word operations each: a minterm matches if
+ * (bits ^ bitset) & mask is empty, the same test as getConflicts. The bitsets and masks of all
+ * minterms are stored in one contiguous array. Batches of records are evaluated column by column,
+ * see select().
+ */
+class CompiledFilter {
+public:
+    // Compile the expression through its normal form, see transformToNormalForm. Throws
+    // ExpansionBudgetExceeded if the budget of the options is exhausted, see tryCompileFilter.
+    explicit CompiledFilter(const Expression& expr,
+                            const NormalFormOptions& options = kCompileOptions);
+
+    // Compile the normal form, the bits of the minterms are the predicates of the expressions.
+    CompiledFilter(const Maxterm& maxterm, const std::vector<Expression>& expressions);
+
+    bool matches(const Document& document) const;
+
+    // Evaluate every predicate on the document, the bit i is the value of the predicate i.
+    Bitset evaluatePredicates(const Document& document) const;
+
+    // Return true if some minterm matches the values of the predicates.
+    bool matchesPredicates(const Bitset& bits) const;
+
+    /**
+     * Return the selection bitmap of the batch, the bit r is set if the row r matches. Every
+     * predicate is evaluated over its whole column into a bitmap, the columns of the comparisons
+     * are parsed once into TypedColumns. The bitmaps of the literals of a minterm are intersected
+     * and the minterms are united, 64 rows per word operation.
+     */
+    Bitset select(const RecordBatch& batch) const;
+
+    const std::vector<CompiledPredicate>& predicates() const {
+        return _predicates;
+    }
+
+    size_t numMinterms() const {
+        return _numMinterms;
+    }
+
+private:
+    explicit CompiledFilter(const std::pair<Maxterm, std::vector<Expression>>& normalForm);
+
+    std::vector<CompiledPredicate> _predicates;
+    size_t _numWords;
+    size_t _numMinterms;
+    // Words of the bitset followed by the words of the mask of every minterm, numWords each.
+    std::vector<Bitset::Word> _minterms;
+};
+
+struct CompileResult {
+    ExpansionStatus status;
+    // The compiled filter, empty if the budget was exhausted.
+    std::optional<CompiledFilter> filter;
+};
+
+/* Same as the CompiledFilter constructor, but stops the expansion to the normal form cleanly when
+ * the budget is exhausted and reports it in the status of the result.*/
+CompileResult tryCompileFilter(const Expression& expr,
+                               const NormalFormOptions& options = kCompileOptions);
+}  // namespace predicate_optimizer
@@ -0,0 +1,253 @@
+#include "Catch2/catch_amalgamated.hpp"
+#include "predicate_optimizer/compiled_filter.h"
+#include "predicate_optimizer/expression_utils.h"
+#include "predicate_optimizer/optimizer.h"
+#include <algorithm>
+#include <random>
+
+namespace predicate_optimizer {
+namespace {
+// Tree walking evaluation, the reference of the compiled filters.
+struct Evaluator {
+    bool operator()(const Expression&, const LogicalExpression& expr) const {
+        auto evaluate = [&](const Expression& child) { return child.visit(*this); };
+        return expr.op == LogicalOperator::And
+            ? std::all_of(begin(expr.children), end(expr.children), evaluate)
+            : std::any_of(begin(expr.children), end(expr.children), evaluate);
+    }
+
+    bool operator()(const Expression&, const ComparisonExpression& expr) const {
+        auto pos = document.find(expr.path);
+        if (pos == document.end()) {
+            return expr.op == ComparisonOperator::NE || expr.op == ComparisonOperator::LT ||
+                expr.op == ComparisonOperator::LE;
+        }
+        switch (expr.op) {
+            case ComparisonOperator::EQ:
+                return pos->second == expr.value;
+            case ComparisonOperator::NE:
+                return pos->second != expr.value;
+            case ComparisonOperator::GT:
+                return pos->second > expr.value;
+            case ComparisonOperator::GE:
+                return pos->second >= expr.value;
+            case ComparisonOperator::LE:
+                return pos->second <= expr.value;
+            case ComparisonOperator::LT:
+                return pos->second < expr.value;
+        }
+        __builtin_unreachable();
+    }
+
+    bool operator()(const Expression&, const InExpression& expr) const {
+        auto pos = document.find(expr.path);
+        const bool isIn = pos != document.end() &&
+            std::find(begin(expr.values), end(expr.values), pos->second) != end(expr.values);
+        return isIn == (expr.op == InOperator::In);
+    }
+
+    bool operator()(const Expression&, const NotExpression& expr) const {
+        return !expr.child.visit(*this);
+    }
+
+    const Document& document;
+};
+
+std::vector<Document> makeDocuments(size_t numDocuments) {
+    std::mt19937 gen{42};
+    std::uniform_int_distribution<int> digit{0, 9};
+    std::vector<Document> documents{};
+    for (size_t i = 0; i < numDocuments; ++i) {
+        auto& document = documents.emplace_back();
+        for (const char* path : {"a", "b", "c"}) {
+            // Paths are missing in a tenth of the documents.
+            if (int value = digit(gen); value != 0) {
+                document.emplace(path, std::to_string(value));
+            }
+        }
+    }
+    return documents;
+}
+
+// Columnar batch of the first numRows documents.
+RecordBatch makeBatch(const std::vector<Document>& documents, size_t numRows) {
+    RecordBatch batch{numRows, {}};
+    for (size_t r = 0; r < numRows; ++r) {
+        for (const auto& [path, value] : documents[r]) {
+            auto& column = batch.columns[path];
+            column.values.resize(numRows);
+            column.values[r] = value;
+            column.present.set(r);
+        }
+    }
+    return batch;
+}
+}  // namespace
+
+TEST_CASE("Compiled filter", "") {
+    const auto documents = makeDocuments(1000);
+
+    auto expr = GENERATE(
+        makeEq("a", "1"),
+        makeNe("a", "1"),
+        makeOr({}),
+        makeAnd({makeGt("a", "3"), makeLe("a", "7"), makeNotIn("b", {"1", "2", "3"})}),
+        makeOr({makeAnd({makeGe("a", "5"), makeLt("b", "5")}), makeIn("c", {"2", "4", "6"})}),
+        makeNot(makeAnd({makeOr({makeEq("a", "1"), makeGt("b", "4")}),
+                         makeOr({makeNe("a", "1"), makeNotIn("c", {"1", "2"})})})),
+        makeOr({makeAnd({makeEq("a", "1"), makeEq("b", "1")}),
+                makeAnd({makeEq("a", "1"), makeNot(makeEq("b", "1"))}),
+                makeAnd({makeGe("c", "3"), makeLt("c", "6"), makeNe("c", "4")})}));
+
+    CompiledFilter filter{expr};
+    CompiledFilter optimizedFilter{optimize(expr).expression};
+
+    for (const auto& document : documents) {
+        const bool expected = expr.visit(Evaluator{document});
+        REQUIRE(filter.matches(document) == expected);
+        REQUIRE(optimizedFilter.matches(document) == expected);
+    }
+
+    // Batches of the documents of sizes around the word boundaries.
+    for (size_t numRows : {0, 1, 63, 64, 65, 200}) {
+        auto batch = makeBatch(documents, numRows);
+        auto selection = filter.select(batch);
+        for (size_t r = 0; r < numRows; ++r) {
+            REQUIRE(selection[r] == expr.visit(Evaluator{documents[r]}));
+        }
+        REQUIRE(selection.count() <= numRows);
+        REQUIRE(optimizedFilter.select(batch) == selection);
+    }
+}
+
+TEST_CASE("Compiled filter of a normal form", "") {
+    std::vector<Expression> expressions{makeGe("a", "5"), makeIn("b", {"1", "2"})};
+    Maxterm maxterm{{"01"_b, "11"_b}, {"10"_b, "10"_b}};
+
+    CompiledFilter filter{maxterm, expressions};
+
+    REQUIRE(filter.numMinterms() == 2);
+    REQUIRE(filter.predicates().size() == 2);
+    REQUIRE(filter.evaluatePredicates({{"a", "7"}, {"b", "3"}}) == "01"_b);
+    REQUIRE(filter.matches({{"a", "7"}, {"b", "3"}}));
+    REQUIRE(filter.matches({{"b", "2"}}));
+    REQUIRE_FALSE(filter.matches({{"a", "1"}, {"b", "3"}}));
+    REQUIRE_FALSE(filter.matches({}));
+
+    RecordBatch batch{3, {}};
+    batch.columns["a"] = {{"7", "1", ""}, "011"_b};
+    batch.columns["b"] = {{"3", "3", "2"}, "111"_b};
+    REQUIRE(filter.select(batch) == "101"_b);
+
+    REQUIRE_THROWS_AS(CompiledFilter(maxterm, {makeAnd({}), makeEq("a", "1")}),
+                      std::runtime_error);
+
+    // $in and $nin of no values.
+    CompiledFilter emptyIn{Maxterm{{"1"_b, "1"_b}}, {makeIn("a", {})}};
+    CompiledFilter emptyNotIn{Maxterm{{"1"_b, "1"_b}}, {makeNotIn("a", {})}};
+    REQUIRE(emptyIn.select(batch) == "000"_b);
+    REQUIRE(emptyNotIn.select(batch) == "111"_b);
+}
+
+TEST_CASE("Compiled filter budget", "") {
+    // $and of ten 5-way $or expands to 5^10 minterms.
+    std::vector<Expression> ors{};
+    for (int i = 0; i < 10; ++i) {
+        std::vector<Expression> children{};
+        for (int j = 0; j < 5; ++j) {
+            children.emplace_back(makeEq("a" + std::to_string(i), std::to_string(j)));
+        }
+        ors.emplace_back(makeOr(std::move(children)));
+    }
+    auto expr = makeAnd(std::move(ors));
+
+    auto result = tryCompileFilter(expr);
+    REQUIRE(result.status == ExpansionStatus::MintermLimitExceeded);
+    REQUIRE_FALSE(result.filter.has_value());
+    REQUIRE_THROWS_AS(CompiledFilter{expr}, ExpansionBudgetExceeded);
+
+    // Contradictions are pruned by default.
+    auto contradiction = makeAnd({makeGt("a", "5"), makeLt("a", "3")});
+    auto pruned = tryCompileFilter(contradiction);
+    REQUIRE(pruned.status == ExpansionStatus::Ok);
+    REQUIRE(pruned.filter->numMinterms() == 0);
+    REQUIRE(tryCompileFilter(contradiction, {}).filter->numMinterms() == 1);
+}
+
+TEST_CASE("Compiled comparisons of typed columns", "") {
+    std::mt19937 gen{7};
+    // Column of values made from random integers in [0, 8), a tenth of the rows are missing.
+    auto makeColumn = [&](size_t numRows, std::string (*makeValue)(uint32_t)) {
+        Column column{std::vector<Value>(numRows), Bitset::zeros(numRows)};
+        for (size_t r = 0; r < numRows; ++r) {
+            if (gen() % 10 != 0) {
+                column.values[r] = makeValue(gen() % 8);
+                column.present.set(r);
+            }
+        }
+        return column;
+    };
+
+    std::vector<std::pair<std::string (*)(uint32_t), TypedColumn::Type>> columnTypes{
+        {[](uint32_t i) { return std::to_string(static_cast<int>(i) - 4); },
+         TypedColumn::Type::Int64},
+        {[](uint32_t i) { return std::to_string(i) + "e-1"; }, TypedColumn::Type::Double},
+        {[](uint32_t i) { return "2024-01-0" + std::to_string(i + 1); }, TypedColumn::Type::Date},
+        {[](uint32_t i) { return i % 2 == 0 ? std::to_string(i) : std::to_string(i) + "e0"; },
+         TypedColumn::Type::Mixed},
+        {[](uint32_t i) { return std::to_string(i) + ".5"; }, TypedColumn::Type::Mixed},
+    };
+    std::vector<Value> operands{
+        "-1", "0", "3", "0.3", "5e-1", "2024-01-04", "2024-01-04T12:00:00", "x"};
+    std::vector<Expression (*)(Path, Value)> makers{makeEq, makeNe, makeGe, makeGt, makeLe, makeLt};
+
+    for (size_t numRows : {0, 1, 63, 64, 65, 130, 200}) {
+        for (const auto& [makeValue, type] : columnTypes) {
+            const auto column = makeColumn(numRows, makeValue);
+            // The values of a long column mix the integers and doubles of the Mixed column.
+            if (numRows >= Bitset::kWordBits) {
+                REQUIRE(TypedColumn{column, numRows}.type == type);
+            }
+
+            for (const auto& operand : operands) {
+                for (auto make : makers) {
+                    CompiledPredicate predicate{make("a", operand)};
+                    auto bits = Bitset::zeros(numRows);
+                    predicate.evaluate(&column, numRows, bits.data());
+
+                    auto expected = Bitset::zeros(numRows);
+                    for (size_t r = 0; r < numRows; ++r) {
+                        const auto* value = column.present[r] ? &column.values[r] : nullptr;
+                        if (predicate.evaluate(value)) {
+                            expected.set(r);
+                        }
+                    }
+                    REQUIRE(bits == expected);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Compiled $in of many values", "") {
+    std::vector<Value> values{"x0", "x1", "2024-01-01", "1e2"};
+    for (int i = 0; i < 100; i += 2) {
+        values.emplace_back(i % 4 == 0 ? std::to_string(i) : std::to_string(i) + ".0");
+    }
+    std::shuffle(begin(values), end(values), std::mt19937{42});
+    CompiledPredicate predicate{makeIn("a", values)};
+    REQUIRE(predicate.typedValues.size() == values.size());
+
+    std::vector<Value> probes{"2.00", "4e0", "100", "x1", "x2", "2024-01-01T00:00:00", "abc"};
+    for (int i = 0; i <= 110; ++i) {
+        probes.emplace_back(std::to_string(i));
+    }
+    for (const auto& probe : probes) {
+        const bool expected = std::any_of(begin(values), end(values), [&](const Value& value) {
+            return value.typed() == probe.typed();
+        });
+        REQUIRE(predicate.isIn(probe) == expected);
+        REQUIRE(predicate.evaluate(&probe) == expected);
+    }
+}
+}  // namespace predicate_optimizer
@@ -0,0 +1,169 @@
+#include "predicate_optimizer/cover_selection.h"
+#include "predicate_optimizer/cover_table.h"
+#include "predicate_optimizer/petrick.h"
+
+#include <algorithm>
+#include <optional>
+
+namespace predicate_optimization {
+namespace {
+/**
+ * A cover of the cyclic core of the table, together with the number of selected implicants covering
+ * every minterm.
+ */
+struct Cover {
+    explicit Cover(const CoverTable& table) : table(table), coverCount(table.implicantsOf.size()) {}
+
+    void add(size_t implicantIndex) {
+        selected.emplace_back(implicantIndex);
+        table.mintermsOf[implicantIndex].forEachSetBit(
+            [&](size_t mintermIndex) { ++coverCount[mintermIndex]; });
+    }
+
+    void remove(size_t position) {
+        table.mintermsOf[selected[position]].forEachSetBit(
+            [&](size_t mintermIndex) { --coverCount[mintermIndex]; });
+        selected.erase(selected.begin() + position);
+    }
+
+    bool isSelected(size_t implicantIndex) const {
+        return std::find(selected.begin(), selected.end(), implicantIndex) != selected.end();
+    }
+
+    // Pick the implicant covering most uncovered minterms until all minterms are covered.
+    void greedy() {
+        Bitset uncovered = table.activeMinterms;
+        while (uncovered.any()) {
+            size_t bestImplicant = 0;
+            size_t bestCount = 0;
+            table.activeImplicants.forEachSetBit([&](size_t implicantIndex) {
+                const size_t count = (table.mintermsOf[implicantIndex] & uncovered).count();
+                if (count > bestCount) {
+                    bestImplicant = implicantIndex;
+                    bestCount = count;
+                }
+            });
+
+            add(bestImplicant);
+            table.mintermsOf[bestImplicant].forEachSetBit(
+                [&](size_t mintermIndex) { uncovered.reset(mintermIndex); });
+        }
+    }
+
+    // Remove selected implicants whose minterms are all covered by other selected implicants,
+    // implicants covering fewer minterms are tried first.
+    void irredundant() {
+        std::vector<size_t> order(selected.begin(), selected.end());
+        std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+            return table.mintermsOf[lhs].count() < table.mintermsOf[rhs].count();
+        });
+
+        for (auto implicantIndex : order) {
+            bool redundant = true;
+            table.mintermsOf[implicantIndex].forEachSetBit(
+                [&](size_t mintermIndex) { redundant &= coverCount[mintermIndex] >= 2; });
+            if (redundant) {
+                remove(std::find(selected.begin(), selected.end(), implicantIndex) -
+                       selected.begin());
+            }
+        }
+    }
+
+    // Reduce a pair of selected implicants to the minterms no other selected implicant covers and
+    // try to expand them into a single implicant covering those minterms. Return true if a pair
+    // was replaced.
+    bool mergePair() {
+        for (size_t lhs = 0; lhs < selected.size(); ++lhs) {
+            for (size_t rhs = lhs + 1; rhs < selected.size(); ++rhs) {
+                const auto& lhsMinterms = table.mintermsOf[selected[lhs]];
+                const auto& rhsMinterms = table.mintermsOf[selected[rhs]];
+
+                Bitset reduced = lhsMinterms | rhsMinterms;
+                reduced.forEachSetBit([&](size_t mintermIndex) {
+                    const size_t pairCount =
+                        lhsMinterms.test(mintermIndex) + rhsMinterms.test(mintermIndex);
+                    if (coverCount[mintermIndex] > pairCount) {
+                        reduced.reset(mintermIndex);
+                    }
+                });
+
+                std::optional<size_t> expanded{};
+                table.activeImplicants.forEachSetBit([&](size_t implicantIndex) {
+                    if (!expanded && !isSelected(implicantIndex) &&
+                        reduced.isSubsetOf(table.mintermsOf[implicantIndex])) {
+                        expanded = implicantIndex;
+                    }
+                });
+
+                if (expanded) {
+                    remove(rhs);
+                    remove(lhs);
+                    add(*expanded);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    std::vector<std::vector<unsigned>> result() const {
+        std::vector<unsigned> cover(table.essentials.begin(), table.essentials.end());
+        cover.insert(cover.end(), selected.begin(), selected.end());
+        std::sort(cover.begin(), cover.end());
+        return {cover};
+    }
+
+    const CoverTable& table;
+    std::vector<unsigned> selected;
+    std::vector<size_t> coverCount;
+};
+}  // namespace
+
+std::vector<std::vector<unsigned>> greedyCover(const std::vector<std::vector<unsigned>>& data,
+                                               const std::vector<size_t>& costs) {
+    CoverTable table{data, costs};
+    if (table.hasUncoveredMinterms()) {
+        return {};
+    }
+    table.reduce();
+
+    Cover cover{table};
+    cover.greedy();
+    return cover.result();
+}
+
+std::vector<std::vector<unsigned>> iterativeCover(const std::vector<std::vector<unsigned>>& data,
+                                                  const std::vector<size_t>& costs) {
+    CoverTable table{data, costs};
+    if (table.hasUncoveredMinterms()) {
+        return {};
+    }
+    table.reduce();
+
+    Cover cover{table};
+    cover.greedy();
+    do {
+        cover.irredundant();
+    } while (cover.mergePair());
+    return cover.result();
+}
+
+std::vector<std::vector<unsigned>> selectCover(const std::vector<std::vector<unsigned>>& data,
+                                               const CoverOptions& options,
+                                               const std::vector<size_t>& costs) {
+    switch (options.mode) {
+        case CoverMode::Auto:
+            if (data.size() <= options.maxExactImplicants) {
+                return petrick(data, costs);
+            }
+            return iterativeCover(data, costs);
+        case CoverMode::Exact:
+            return petrick(data, costs);
+        case CoverMode::Greedy:
+            return greedyCover(data, costs);
+        case CoverMode::Iterative:
+            return iterativeCover(data, costs);
+    }
+    __builtin_unreachable();
+}
+}  // namespace predicate_optimization
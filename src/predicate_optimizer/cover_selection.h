@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace predicate_optimization {
+enum class CoverMode {
+    // Exact for small tables, Iterative otherwise.
+    Auto,
+    // Petrick's method, exponential in the size of the cyclic core.
+    Exact,
+    // Greedy set cover.
+    Greedy,
+    // Greedy set cover improved by Espresso-style reduce, expand and irredundant iterations.
+    Iterative,
+};
+
+struct CoverOptions {
+    CoverMode mode{CoverMode::Auto};
+    // Auto mode uses Petrick's method up to this number of implicants.
+    size_t maxExactImplicants{20};
+};
+
+/**
+ * Select covers of the input minterms. Takes the same coverage list and costs as petrick() and
+ * returns a list of covers in the same format. The exact mode returns all covers found by Petrick's
+ * method, the heuristic modes run in polynomial time and return a single cover, or none if some
+ * minterm is not covered by any implicant.
+ */
+std::vector<std::vector<unsigned>> selectCover(const std::vector<std::vector<unsigned>>& data,
+                                               const CoverOptions& options = {},
+                                               const std::vector<size_t>& costs = {});
+
+std::vector<std::vector<unsigned>> greedyCover(const std::vector<std::vector<unsigned>>& data,
+                                               const std::vector<size_t>& costs = {});
+
+std::vector<std::vector<unsigned>> iterativeCover(const std::vector<std::vector<unsigned>>& data,
+                                                  const std::vector<size_t>& costs = {});
+}  // namespace predicate_optimization
@@ -0,0 +1,81 @@
+#include "Catch2/catch_amalgamated.hpp"
+#include "cover_selection.h"
+#include <algorithm>
+#include <vector>
+
+namespace predicate_optimization {
+namespace {
+bool isCover(const std::vector<std::vector<unsigned>>& data,
+             const std::vector<unsigned>& cover,
+             unsigned numMinterms) {
+    std::vector<bool> covered(numMinterms, false);
+    for (auto implicantIndex : cover) {
+        for (auto mintermIndex : data.at(implicantIndex)) {
+            covered[mintermIndex] = true;
+        }
+    }
+    return std::find(covered.begin(), covered.end(), false) == covered.end();
+}
+}  // namespace
+
+TEST_CASE("Cover selection", "") {
+    std::vector<std::vector<unsigned>> cyclic{
+        {0, 1},
+        {0, 3},
+        {1, 2},
+        {3, 4},
+        {2, 5},
+        {4, 5},
+    };
+
+    SECTION("greedy") {
+        std::vector<std::vector<unsigned>> expectedResult{{0, 3, 4}};
+        REQUIRE(expectedResult == greedyCover(cyclic));
+        REQUIRE(expectedResult == selectCover(cyclic, {.mode = CoverMode::Greedy}));
+    }
+
+    SECTION("iterative") {
+        std::vector<std::vector<unsigned>> expectedResult{{0, 3, 4}};
+        REQUIRE(expectedResult == iterativeCover(cyclic));
+    }
+
+    SECTION("auto mode is exact for small tables") {
+        REQUIRE(selectCover(cyclic).size() == 5);
+        REQUIRE(selectCover(cyclic, {.maxExactImplicants = 5}).size() == 1);
+    }
+
+    SECTION("uncovered minterm") {
+        REQUIRE(greedyCover({{0}, {2}}).empty());
+        REQUIRE(iterativeCover({{0}, {2}}).empty());
+    }
+
+    SECTION("hundreds of implicants") {
+        // Every implicant covers a pseudo-random window of minterms.
+        const unsigned numMinterms = 400;
+        std::vector<std::vector<unsigned>> data{};
+        unsigned state = 12345;
+        for (unsigned i = 0; i < 600; ++i) {
+            state = state * 1103515245 + 12345;
+            const unsigned begin = (state >> 8) % numMinterms;
+            const unsigned length = 1 + (state >> 20) % 12;
+            std::vector<unsigned> covered{};
+            for (unsigned m = begin; m < std::min(numMinterms, begin + length); ++m) {
+                covered.push_back(m);
+            }
+            data.push_back(covered);
+        }
+        for (unsigned m = 0; m < numMinterms; ++m) {
+            data.push_back({m});
+        }
+
+        auto greedy = greedyCover(data);
+        auto iterative = iterativeCover(data);
+        REQUIRE(greedy.size() == 1);
+        REQUIRE(iterative.size() == 1);
+        REQUIRE(isCover(data, greedy.front(), numMinterms));
+        REQUIRE(isCover(data, iterative.front(), numMinterms));
+        REQUIRE(iterative.front().size() <= greedy.front().size());
+        REQUIRE(selectCover(data) == iterative);
+    }
+}
+}  // namespace predicate_optimization
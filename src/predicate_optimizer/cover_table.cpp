@@ -0,0 +1,120 @@
+#include "predicate_optimizer/cover_table.h"
+
+#include <algorithm>
+
+namespace predicate_optimization {
+CoverTable::CoverTable(const std::vector<std::vector<unsigned>>& data,
+                       const std::vector<size_t>& costs)
+    : numImplicants(data.size()), costs(costs.empty() ? std::vector<size_t>(data.size()) : costs) {
+    size_t numMinterms = 0;
+    for (const auto& covered : data) {
+        for (auto mintermIndex : covered) {
+            numMinterms = std::max<size_t>(numMinterms, mintermIndex + 1);
+        }
+    }
+
+    mintermsOf.assign(numImplicants, Bitset::zeros(numMinterms));
+    implicantsOf.assign(numMinterms, Bitset::zeros(numImplicants));
+    activeImplicants = Bitset::zeros(numImplicants);
+    activeMinterms = Bitset::zeros(numMinterms);
+
+    for (size_t implicantIndex = 0; implicantIndex < numImplicants; ++implicantIndex) {
+        activeImplicants.set(implicantIndex);
+        for (auto mintermIndex : data[implicantIndex]) {
+            mintermsOf[implicantIndex].set(mintermIndex);
+            implicantsOf[mintermIndex].set(implicantIndex);
+            activeMinterms.set(mintermIndex);
+        }
+    }
+}
+
+bool CoverTable::hasUncoveredMinterms() const {
+    return activeMinterms.count() != implicantsOf.size();
+}
+
+void CoverTable::removeImplicant(size_t implicantIndex) {
+    activeImplicants.reset(implicantIndex);
+    mintermsOf[implicantIndex].forEachSetBit(
+        [&](size_t mintermIndex) { implicantsOf[mintermIndex].reset(implicantIndex); });
+}
+
+void CoverTable::removeMinterm(size_t mintermIndex) {
+    activeMinterms.reset(mintermIndex);
+    implicantsOf[mintermIndex].forEachSetBit(
+        [&](size_t implicantIndex) { mintermsOf[implicantIndex].reset(mintermIndex); });
+}
+
+bool CoverTable::extractEssentials() {
+    bool changed = false;
+    activeMinterms.forEachSetBit([&](size_t mintermIndex) {
+        if (!activeMinterms[mintermIndex] || implicantsOf[mintermIndex].count() != 1) {
+            return;
+        }
+
+        size_t implicantIndex = 0;
+        implicantsOf[mintermIndex].forEachSetBit([&](size_t index) { implicantIndex = index; });
+        essentials.emplace_back(implicantIndex);
+        Bitset covered = mintermsOf[implicantIndex];
+        covered.forEachSetBit([&](size_t index) { removeMinterm(index); });
+        removeImplicant(implicantIndex);
+        changed = true;
+    });
+    return changed;
+}
+
+bool CoverTable::removeDominatingMinterms() {
+    bool changed = false;
+    activeMinterms.forEachSetBit([&](size_t lhs) {
+        activeMinterms.forEachSetBit([&](size_t rhs) {
+            if (lhs == rhs || !activeMinterms[lhs] || !activeMinterms[rhs]) {
+                return;
+            }
+            const auto& lhsImplicants = implicantsOf[lhs];
+            const auto& rhsImplicants = implicantsOf[rhs];
+            // On equal columns keep the one with the lower index.
+            if (rhsImplicants.isSubsetOf(lhsImplicants) &&
+                (rhs < lhs || !lhsImplicants.isSubsetOf(rhsImplicants))) {
+                removeMinterm(lhs);
+                changed = true;
+            }
+        });
+    });
+    return changed;
+}
+
+bool CoverTable::removeDominatedImplicants() {
+    bool changed = false;
+    activeImplicants.forEachSetBit([&](size_t lhs) {
+        if (mintermsOf[lhs].none()) {
+            removeImplicant(lhs);
+            changed = true;
+            return;
+        }
+
+        activeImplicants.forEachSetBit([&](size_t rhs) {
+            if (lhs == rhs || !activeImplicants[lhs] || !activeImplicants[rhs]) {
+                return;
+            }
+            const auto& lhsMinterms = mintermsOf[lhs];
+            const auto& rhsMinterms = mintermsOf[rhs];
+            // A costlier implicant never replaces a cheaper one, and equal rows of the same cost
+            // are both kept: the covers using either of them are equally small.
+            if (lhsMinterms.isSubsetOf(rhsMinterms) && costs[rhs] <= costs[lhs] &&
+                (costs[rhs] < costs[lhs] || !rhsMinterms.isSubsetOf(lhsMinterms))) {
+                removeImplicant(lhs);
+                changed = true;
+            }
+        });
+    });
+    return changed;
+}
+
+void CoverTable::reduce() {
+    bool changed = true;
+    while (changed) {
+        changed = extractEssentials();
+        changed |= removeDominatingMinterms();
+        changed |= removeDominatedImplicants();
+    }
+}
+}  // namespace predicate_optimization
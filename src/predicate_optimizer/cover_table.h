@@ -0,0 +1,49 @@
+#pragma once
+
+#include "predicate_optimizer/bitset.h"
+#include <vector>
+
+namespace predicate_optimization {
+using predicate_optimizer::Bitset;
+
+/**
+ * The covering table of Petrick's method and of the heuristic cover selection. Every row is an
+ * implicant and every column a minterm, the table is kept in both orientations so that rows and
+ * columns can be compared as bitsets. Rows and columns removed by the reduction are cleared from
+ * the other orientation.
+ */
+struct CoverTable {
+    // The costs of the implicants, e.g. their numbers of literals, decide which of two implicants
+    // covering the same minterms is kept. Implicants without costs all cost the same.
+    explicit CoverTable(const std::vector<std::vector<unsigned>>& data,
+                        const std::vector<size_t>& costs = {});
+
+    // Return true if there is a minterm in the middle of the index range no implicant covers.
+    bool hasUncoveredMinterms() const;
+
+    void removeImplicant(size_t implicantIndex);
+    void removeMinterm(size_t mintermIndex);
+
+    // Select implicants which are the only ones covering a minterm, remove the minterms they cover.
+    bool extractEssentials();
+
+    // Remove a minterm if every implicant covering another minterm covers it too: covering the
+    // other minterm covers this one.
+    bool removeDominatingMinterms();
+
+    // Remove an implicant if another implicant costing no more covers all of its remaining
+    // minterms. Implicants covering the same minterms at the same cost are kept as alternatives.
+    bool removeDominatedImplicants();
+
+    // Reduce the table to its cyclic core.
+    void reduce();
+
+    size_t numImplicants;
+    std::vector<size_t> costs;
+    std::vector<Bitset> mintermsOf;
+    std::vector<Bitset> implicantsOf;
+    Bitset activeImplicants;
+    Bitset activeMinterms;
+    std::vector<unsigned> essentials;
+};
+}  // namespace predicate_optimization
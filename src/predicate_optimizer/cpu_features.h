@@ -0,0 +1,19 @@
+#pragma once
+
+// Internal header of the SIMD kernels. PREDICATE_OPTIMIZER_HAS_AVX2_KERNEL is defined when the
+// compiler can build AVX2 functions with __attribute__((target("avx2"))), whether to call them is
+// decided at runtime by hasAvx2().
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define PREDICATE_OPTIMIZER_HAS_AVX2_KERNEL 1
+#endif
+
+namespace predicate_optimizer {
+#ifdef PREDICATE_OPTIMIZER_HAS_AVX2_KERNEL
+// Return true if the CPU running the process supports AVX2, checked once.
+inline bool hasAvx2() {
+    static const bool result = __builtin_cpu_supports("avx2");
+    return result;
+}
+#endif
+}  // namespace predicate_optimizer
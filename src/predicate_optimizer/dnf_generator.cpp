@@ -0,0 +1,141 @@
+#include "predicate_optimizer/dnf_generator.h"
+
+namespace predicate_optimizer {
+DNFConjunctGenerator::DNFConjunctGenerator(const Expression& expr) {
+    build(expr);
+}
+
+bool DNFConjunctGenerator::next() {
+    if (_done) {
+        return false;
+    }
+
+    const bool hasConjunct = _started ? advance(0) : reset(0);
+    _started = true;
+    if (!hasConjunct) {
+        _done = true;
+        _conjunct.clear();
+        return false;
+    }
+
+    _conjunct.clear();
+    append(0);
+    return true;
+}
+
+Expression DNFConjunctGenerator::makeConjunct() const {
+    std::vector<Expression> children{};
+    children.reserve(_conjunct.size());
+    for (const auto* leaf : _conjunct) {
+        children.emplace_back(*leaf);
+    }
+    return Expression::make<LogicalExpression>(LogicalOperator::And, std::move(children));
+}
+
+size_t DNFConjunctGenerator::build(const Expression& expr) {
+    const size_t index = _cursors.size();
+    auto logical = expr.cast<LogicalExpression>();
+    if (!logical) {
+        _cursors.push_back({CursorKind::Leaf, &expr});
+        return index;
+    }
+
+    const bool isAnd = logical->op == LogicalOperator::And;
+    _cursors.push_back({isAnd ? CursorKind::And : CursorKind::Or});
+    std::vector<size_t> children{};
+    std::vector<size_t> varyingChildren{};
+    children.reserve(logical->children.size());
+    for (const auto& child : logical->children) {
+        const size_t childIndex = build(child);
+        children.push_back(childIndex);
+        if (_cursors[childIndex].isVarying) {
+            varyingChildren.push_back(childIndex);
+        }
+    }
+
+    auto& cursor = _cursors[index];
+    cursor.isVarying = !isAnd || !varyingChildren.empty();
+    cursor.children = std::move(children);
+    if (isAnd) {
+        cursor.varyingChildren = std::move(varyingChildren);
+    }
+    return index;
+}
+
+// Move the cursor to the first conjunct of its node, return false if the node has no conjuncts.
+bool DNFConjunctGenerator::reset(size_t index) {
+    auto& cursor = _cursors[index];
+    switch (cursor.kind) {
+        case CursorKind::Leaf:
+            return true;
+        case CursorKind::And:
+            for (auto child : cursor.children) {
+                if (!reset(child)) {
+                    return false;
+                }
+            }
+            return true;
+        case CursorKind::Or:
+            for (cursor.current = 0; cursor.current < cursor.children.size(); ++cursor.current) {
+                if (reset(cursor.children[cursor.current])) {
+                    return true;
+                }
+            }
+            return false;
+    }
+    __builtin_unreachable();
+}
+
+// Move the cursor to the next conjunct of its node, return false if it was the last one.
+bool DNFConjunctGenerator::advance(size_t index) {
+    auto& cursor = _cursors[index];
+    switch (cursor.kind) {
+        case CursorKind::Leaf:
+            return false;
+        case CursorKind::And:
+            for (size_t i = cursor.varyingChildren.size(); i > 0; --i) {
+                const size_t child = cursor.varyingChildren[i - 1];
+                if (advance(child)) {
+                    return true;
+                }
+                reset(child);
+            }
+            return false;
+        case CursorKind::Or:
+            if (advance(cursor.children[cursor.current])) {
+                return true;
+            }
+            while (++cursor.current < cursor.children.size()) {
+                if (reset(cursor.children[cursor.current])) {
+                    return true;
+                }
+            }
+            return false;
+    }
+    __builtin_unreachable();
+}
+
+// Append the leaves of the current conjunct of the node. The leaves of an $and come in the order of
+// DNFTransformer: the children which are not $ors first, then the terms of the $ors.
+void DNFConjunctGenerator::append(size_t index) {
+    const auto& cursor = _cursors[index];
+    switch (cursor.kind) {
+        case CursorKind::Leaf:
+            _conjunct.push_back(cursor.leaf);
+            break;
+        case CursorKind::And:
+            for (auto child : cursor.children) {
+                if (!_cursors[child].isVarying) {
+                    append(child);
+                }
+            }
+            for (auto child : cursor.varyingChildren) {
+                append(child);
+            }
+            break;
+        case CursorKind::Or:
+            append(cursor.children[cursor.current]);
+            break;
+    }
+}
+}  // namespace predicate_optimizer
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "predicate_optimizer/expression.h"
+#include <cstddef>
+#include <vector>
+
+namespace predicate_optimizer {
+/**
+ * Lazy DNF of an expression without negations: yields the conjuncts of transformToDNF one at a
+ * time, in the same order and with the leaves in the same order, without building the disjunction.
+ * The conjuncts of an $and are enumerated by an odometer over its $or children, the last $or
+ * changes first, so that the memory used is proportional to the size of the expression and not to
+ * the number of conjuncts. The leaves refer to the expression, which must outlive the generator.
+ *
+ *     DNFConjunctGenerator generator{expr};
+ *     while (generator.next()) {
+ *         use(generator.conjunct());
+ *     }
+ */
+class DNFConjunctGenerator {
+public:
+    explicit DNFConjunctGenerator(const Expression& expr);
+
+    // Advance to the next conjunct, return false if there are no more conjuncts.
+    bool next();
+
+    // Leaves of the current conjunct.
+    const std::vector<const Expression*>& conjunct() const {
+        return _conjunct;
+    }
+
+    // $and of copies of the leaves of the current conjunct.
+    Expression makeConjunct() const;
+
+private:
+    enum class CursorKind { Leaf, And, Or };
+
+    // Position in the sequence of conjuncts of a node of the expression.
+    struct Cursor {
+        CursorKind kind;
+        // The leaf, a comparison, $in or $not expression.
+        const Expression* leaf{nullptr};
+        // Cursors of the children of a logical node.
+        std::vector<size_t> children{};
+        // Children of an $and whose DNF is an $or, they are enumerated by the odometer.
+        std::vector<size_t> varyingChildren{};
+        // Index of the current child of an $or.
+        size_t current{0};
+        // True if the DNF of the node is an $or.
+        bool isVarying{false};
+    };
+
+    size_t build(const Expression& expr);
+    bool reset(size_t cursor);
+    bool advance(size_t cursor);
+    void append(size_t cursor);
+
+    std::vector<Cursor> _cursors;
+    std::vector<const Expression*> _conjunct;
+    bool _started{false};
+    bool _done{false};
+};
+}  // namespace predicate_optimizer
@@ -0,0 +1,116 @@
+#include "Catch2/catch_amalgamated.hpp"
+#include "dnf_generator.h"
+#include "expression_dnf.h"
+#include "expression_rewrite.h"
+#include "expression_utils.h"
+#include "intervals_simplifier.h"
+
+namespace predicate_optimizer {
+namespace {
+std::vector<Expression> generateConjuncts(const Expression& expr) {
+    std::vector<Expression> result{};
+    DNFConjunctGenerator generator{expr};
+    while (generator.next()) {
+        result.emplace_back(generator.makeConjunct());
+    }
+    return result;
+}
+
+// Conjuncts of the result of transformToDNF, every one as an $and.
+std::vector<Expression> expectedConjuncts(const Expression& expr) {
+    auto dnf = transformToDNF(expr);
+    auto logical = dnf.cast<LogicalExpression>();
+    if (!logical) {
+        return {makeAnd({std::move(dnf)})};
+    }
+    if (logical->op == LogicalOperator::And) {
+        return {std::move(dnf)};
+    }
+
+    std::vector<Expression> result{};
+    for (auto& child : logical->children) {
+        if (child.is<LogicalExpression>()) {
+            result.emplace_back(std::move(child));
+        } else {
+            result.emplace_back(makeAnd({std::move(child)}));
+        }
+    }
+    return result;
+}
+}  // namespace
+
+TEST_CASE("DNF conjunct generator", "") {
+    SECTION("Same conjuncts as transformToDNF") {
+        std::vector<Expression> expressions{};
+        expressions.emplace_back(makeEq("a", "1"));
+        expressions.emplace_back(makeAnd({makeGe("x", "10"), makeLt("y", "5")}));
+        expressions.emplace_back(makeOr({makeGt("x", "5"),
+                                         makeOr({makeLt("x", "11"), makeEq("x", "5")}),
+                                         makeAnd({makeEq("x", "9"), makeEq("y", "9")})}));
+        expressions.emplace_back(makeAnd({
+            makeOr({makeEq("a", "1")}),
+            makeAnd({makeEq("b", "1"), makeOr({makeEq("c", "1"), makeEq("c", "2")})}),
+            makeEq("d", "1"),
+            makeOr({makeEq("e", "1"), makeAnd({makeEq("e", "2"), makeEq("f", "2")})}),
+        }));
+        expressions.emplace_back(makeOr({
+            makeAnd({makeOr({makeEq("a", "1"), makeEq("b", "1")}),
+                     makeOr({makeEq("c", "1"), makeOr({makeEq("d", "1")})})}),
+            makeAnd({makeEq("e", "1"), makeIn("f", {"1", "2"})}),
+        }));
+
+        for (const auto& expr : expressions) {
+            REQUIRE(expectedConjuncts(expr) == generateConjuncts(expr));
+        }
+    }
+
+    SECTION("Empty $or has no conjuncts") {
+        REQUIRE(generateConjuncts(makeOr({})).empty());
+        REQUIRE(generateConjuncts(makeAnd({makeEq("a", "1"), makeOr({})})).empty());
+        REQUIRE(generateConjuncts(makeOr({makeOr({}), makeEq("a", "1")})) ==
+                std::vector<Expression>{makeAnd({makeEq("a", "1")})});
+    }
+
+    SECTION("Stop early on a wide expansion") {
+        // 2^40 conjuncts.
+        std::vector<Expression> ors{};
+        for (int i = 0; i < 40; ++i) {
+            const auto path = std::to_string(i);
+            ors.emplace_back(makeOr({makeEq(path, "1"), makeEq(path, "2")}));
+        }
+        auto expr = makeAnd(std::move(ors));
+
+        DNFConjunctGenerator generator{expr};
+        for (int i = 0; i < 4; ++i) {
+            REQUIRE(generator.next());
+            REQUIRE(generator.conjunct().size() == 40);
+        }
+        REQUIRE(*generator.conjunct().back() == makeEq("39", "2"));
+        REQUIRE(*generator.conjunct()[38] == makeEq("38", "2"));
+        REQUIRE(*generator.conjunct()[37] == makeEq("37", "1"));
+    }
+
+    SECTION("Drop contradicting conjuncts") {
+        // (a > 6 || a < 4) && (a < 2 || a > 8)
+        auto expr = makeAnd({
+            makeOr({makeGt("a", "6"), makeLt("a", "4")}),
+            makeOr({makeLt("a", "2"), makeGt("a", "8")}),
+        });
+
+        std::vector<Expression> satisfiable{};
+        DNFConjunctGenerator generator{expr};
+        while (generator.next()) {
+            auto conjunct = generator.makeConjunct();
+            auto [maxterm, expressions] = transformToNormalForm(conjunct);
+            if (simplifyIntervals(maxterm.minterms.front(), expressions)) {
+                satisfiable.emplace_back(std::move(conjunct));
+            }
+        }
+
+        std::vector<Expression> expected{};
+        expected.emplace_back(makeAnd({makeGt("a", "6"), makeGt("a", "8")}));
+        expected.emplace_back(makeAnd({makeLt("a", "4"), makeLt("a", "2")}));
+        REQUIRE(expected == satisfiable);
+    }
+}
+}  // namespace predicate_optimizer
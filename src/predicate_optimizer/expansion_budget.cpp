@@ -0,0 +1,58 @@
+#include "predicate_optimizer/expansion_budget.h"
+
+#include <ostream>
+#include <string>
+
+namespace predicate_optimizer {
+namespace {
+std::chrono::steady_clock::time_point makeDeadline(std::chrono::steady_clock::duration maxTime) {
+    const auto now = std::chrono::steady_clock::now();
+    if (maxTime >= std::chrono::steady_clock::time_point::max() - now) {
+        return std::chrono::steady_clock::time_point::max();
+    }
+    return now + maxTime;
+}
+
+const char* toString(ExpansionStatus status) {
+    switch (status) {
+        case ExpansionStatus::Ok:
+            return "Ok";
+        case ExpansionStatus::MintermLimitExceeded:
+            return "MintermLimitExceeded";
+        case ExpansionStatus::MemoryLimitExceeded:
+            return "MemoryLimitExceeded";
+        case ExpansionStatus::TimeLimitExceeded:
+            return "TimeLimitExceeded";
+    }
+    __builtin_unreachable();
+}
+}  // namespace
+
+ExpansionBudgetExceeded::ExpansionBudgetExceeded(ExpansionStatus status)
+    : std::runtime_error(std::string{"Expansion budget exceeded: "} + toString(status)),
+      status(status) {}
+
+ExpansionBudgetTracker::ExpansionBudgetTracker(const ExpansionBudget& budget)
+    : _budget(budget), _deadline(makeDeadline(budget.maxTime)) {}
+
+void ExpansionBudgetTracker::charge(size_t numTerms, size_t numBytes) {
+    if (numTerms > _budget.maxMinterms) {
+        throw ExpansionBudgetExceeded(ExpansionStatus::MintermLimitExceeded);
+    }
+    if (numBytes > _budget.maxBytes) {
+        throw ExpansionBudgetExceeded(ExpansionStatus::MemoryLimitExceeded);
+    }
+    checkTime();
+}
+
+void ExpansionBudgetTracker::checkTime() {
+    if (_deadline != std::chrono::steady_clock::time_point::max() &&
+        std::chrono::steady_clock::now() > _deadline) {
+        throw ExpansionBudgetExceeded(ExpansionStatus::TimeLimitExceeded);
+    }
+}
+
+std::ostream& operator<<(std::ostream& os, ExpansionStatus status) {
+    return os << toString(status);
+}
+}  // namespace predicate_optimizer
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+#include <limits>
+#include <stdexcept>
+
+namespace predicate_optimizer {
+enum class ExpansionStatus { Ok, MintermLimitExceeded, MemoryLimitExceeded, TimeLimitExceeded };
+
+/**
+ * Limits of a normal form expansion. The minterm and memory limits apply to every intermediate
+ * result: a product whose size can exceed them is not materialized. The time limit applies to the
+ * whole expansion. The default budget is unlimited.
+ */
+struct ExpansionBudget {
+    size_t maxMinterms{std::numeric_limits<size_t>::max()};
+    size_t maxBytes{std::numeric_limits<size_t>::max()};
+    std::chrono::steady_clock::duration maxTime{std::chrono::steady_clock::duration::max()};
+};
+
+// Thrown by the expansion when the budget is exhausted, entry points convert it to the status.
+struct ExpansionBudgetExceeded : public std::runtime_error {
+    explicit ExpansionBudgetExceeded(ExpansionStatus status);
+
+    ExpansionStatus status;
+};
+
+// Tracks the budget of a single expansion.
+class ExpansionBudgetTracker {
+public:
+    explicit ExpansionBudgetTracker(const ExpansionBudget& budget);
+
+    // Check that an intermediate result of the given number of terms and bytes fits the budget,
+    // the time limit is checked as well. Throw ExpansionBudgetExceeded otherwise.
+    void charge(size_t numTerms, size_t numBytes);
+
+    // Check the time limit, cheap enough to be called for every produced term.
+    void tick() {
+        if (++_ticks % kTicksPerTimeCheck == 0) {
+            checkTime();
+        }
+    }
+
+    void checkTime();
+
+private:
+    static constexpr size_t kTicksPerTimeCheck = 1024;
+
+    ExpansionBudget _budget;
+    std::chrono::steady_clock::time_point _deadline;
+    size_t _ticks{0};
+};
+
+// Multiply the sizes saturating at the maximum value of size_t.
+inline size_t saturatingMultiply(size_t lhs, size_t rhs) {
+    if (lhs != 0 && rhs > std::numeric_limits<size_t>::max() / lhs) {
+        return std::numeric_limits<size_t>::max();
+    }
+    return lhs * rhs;
+}
+
+std::ostream& operator<<(std::ostream& os, ExpansionStatus status);
+}  // namespace predicate_optimizer
@@ -1,4 +1,5 @@
 #include "expression.h"
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
 
@@ -45,6 +46,15 @@ bool ComparisonExpression::operator==(const ComparisonExpression& other) const {
     return this->value == other.value;
 }
 
+InExpression::InExpression(InOperator op, Path path, std::vector<Value> values)
+    : op(op), path(std::move(path)), values(std::move(values)) {
+    // The values copied from another InExpression are sorted already.
+    if (!std::is_sorted(this->values.begin(), this->values.end())) {
+        std::sort(this->values.begin(), this->values.end());
+    }
+    this->values.erase(std::unique(this->values.begin(), this->values.end()), this->values.end());
+}
+
 bool InExpression::operator==(const InExpression& other) const {
     if (op != other.op) {
         return false;
@@ -89,18 +99,18 @@ std::ostream& operator<<(std::ostream& os, const LogicalExpression& expr) {
 }
 
 std::ostream& operator<<(std::ostream& os, const ComparisonExpression& expr) {
-    os << '{' << std::quoted(expr.path) << ": {" << expr.op << ": " << std::quoted(expr.value)
-       << "}}";
+    os << '{' << std::quoted(expr.path.str()) << ": {" << expr.op << ": "
+       << std::quoted(expr.value.str()) << "}}";
     return os;
 }
 
 std::ostream& operator<<(std::ostream& os, const InExpression& expr) {
-    os << '{' << std::quoted(expr.path) << ": {" << expr.op << ": [";
+    os << '{' << std::quoted(expr.path.str()) << ": {" << expr.op << ": [";
     for (size_t i = 0; i < expr.values.size(); ++i) {
         if (i != 0) {
             os << ", ";
         }
-        os << std::quoted(expr.values[i]);
+        os << std::quoted(expr.values[i].str());
     }
     os << "]}}";
     return os;
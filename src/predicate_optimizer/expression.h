@@ -1,6 +1,8 @@
 #pragma once
 
 #include "predicate_optimizer/hash.h"
+#include "predicate_optimizer/symbol.h"
+#include <cstddef>
 #include <iosfwd>
 #include <mongodb/polyvalue.h>
 #include <string>
@@ -12,12 +14,42 @@ struct LogicalExpression;
 struct ComparisonExpression;
 struct InExpression;
 struct NotExpression;
+}  // namespace predicate_optimizer
+
+namespace mongodb {
+/**
+ * Control block of the Expression nodes: the generic control block with class-specific allocation
+ * functions, which allocate the nodes from the arena of the active ExpressionArena::Scope of the
+ * thread, or from the global heap. The resource is recorded in front of every node, so that nodes
+ * of the arena and of the heap can be mixed in one tree. Other PolyValue types are not affected.
+ */
+template <>
+class ControlBlock<predicate_optimizer::LogicalExpression,
+                   predicate_optimizer::ComparisonExpression,
+                   predicate_optimizer::InExpression,
+                   predicate_optimizer::NotExpression> {
+    const int _tag;
+
+protected:
+    ControlBlock(int tag) noexcept : _tag(tag) {}
+
+public:
+    auto getRuntimeTag() const noexcept {
+        return _tag;
+    }
 
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr, std::size_t size) noexcept;
+};
+}  // namespace mongodb
+
+namespace predicate_optimizer {
 using Expression =
     mongodb::PolyValue<LogicalExpression, ComparisonExpression, InExpression, NotExpression>;
 
-using Path = std::string;
-using Value = std::string;
+// Paths and values are interned, see Symbol.
+using Path = Symbol;
+using Value = Symbol;
 
 enum class LogicalOperator { And, Or };
 
@@ -63,10 +95,11 @@ enum class InOperator { In, NotIn };
 struct InExpression {
     InOperator op;
     Path path;
+    // Sorted and deduplicated, so that the same set of values in any order gives equal expressions
+    // with equal hashes.
     std::vector<Value> values;
 
-    InExpression(InOperator op, Path path, std::vector<Value> values)
-        : op(op), path(std::move(path)), values(std::move(values)) {}
+    InExpression(InOperator op, Path path, std::vector<Value> values);
 
     bool operator==(const InExpression& other) const;
 
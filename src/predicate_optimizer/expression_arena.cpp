@@ -0,0 +1,62 @@
+#include "predicate_optimizer/expression_arena.h"
+
+namespace predicate_optimizer {
+namespace {
+// Resource of the Expression nodes made on the thread, the global heap if null.
+thread_local std::pmr::memory_resource* currentResource = nullptr;
+
+// The resource of a node is stored in front of it, in a header keeping the alignment of the node.
+constexpr size_t kHeaderSize = alignof(std::max_align_t);
+static_assert(sizeof(std::pmr::memory_resource*) <= kHeaderSize);
+}  // namespace
+
+ExpressionArena::Scope::Scope(ExpressionArena& arena) : _previous(currentResource) {
+    currentResource = &arena._resource;
+}
+
+ExpressionArena::Scope::~Scope() {
+    currentResource = _previous;
+}
+
+Expression copyToHeap(const Expression& expr) {
+    struct HeapScope {
+        HeapScope() : previous(currentResource) {
+            currentResource = nullptr;
+        }
+        ~HeapScope() {
+            currentResource = previous;
+        }
+        std::pmr::memory_resource* previous;
+    };
+
+    HeapScope scope{};
+    return Expression{expr};
+}
+}  // namespace predicate_optimizer
+
+namespace mongodb {
+using ExpressionControlBlock = ControlBlock<predicate_optimizer::LogicalExpression,
+                                            predicate_optimizer::ComparisonExpression,
+                                            predicate_optimizer::InExpression,
+                                            predicate_optimizer::NotExpression>;
+
+void* ExpressionControlBlock::operator new(std::size_t size) {
+    using predicate_optimizer::kHeaderSize;
+    auto* resource = predicate_optimizer::currentResource;
+    if (resource == nullptr) {
+        resource = std::pmr::new_delete_resource();
+    }
+
+    auto* memory = static_cast<std::byte*>(
+        resource->allocate(size + kHeaderSize, alignof(std::max_align_t)));
+    *reinterpret_cast<std::pmr::memory_resource**>(memory) = resource;
+    return memory + kHeaderSize;
+}
+
+void ExpressionControlBlock::operator delete(void* ptr, std::size_t size) noexcept {
+    using predicate_optimizer::kHeaderSize;
+    auto* memory = static_cast<std::byte*>(ptr) - kHeaderSize;
+    auto* resource = *reinterpret_cast<std::pmr::memory_resource**>(memory);
+    resource->deallocate(memory, size + kHeaderSize, alignof(std::max_align_t));
+}
+}  // namespace mongodb
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "predicate_optimizer/expression.h"
+#include <cstddef>
+#include <memory_resource>
+
+namespace predicate_optimizer {
+/**
+ * Monotonic arena for the nodes of Expression trees. While a Scope of the arena is active, every
+ * Expression node made or copied on the thread is allocated from the arena instead of the global
+ * heap, and all of them are released at once when the arena is destroyed. One arena is meant for
+ * one optimization request on one thread. Nodes allocated from the arena must be destroyed before
+ * it, copyToHeap() moves a result out of the arena.
+ */
+class ExpressionArena {
+public:
+    explicit ExpressionArena(size_t initialSize = 4096,
+                             std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : _resource(initialSize, upstream) {}
+
+    ExpressionArena(const ExpressionArena&) = delete;
+    ExpressionArena& operator=(const ExpressionArena&) = delete;
+
+    /**
+     * Make the arena the allocator of the Expression nodes of the current thread for the lifetime
+     * of the scope. Scopes may be nested, the previous allocator is restored on exit.
+     */
+    class Scope {
+    public:
+        explicit Scope(ExpressionArena& arena);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        std::pmr::memory_resource* _previous;
+    };
+
+private:
+    std::pmr::monotonic_buffer_resource _resource;
+};
+
+/* Deep copy of the expression whose nodes are allocated from the global heap. */
+Expression copyToHeap(const Expression& expr);
+}  // namespace predicate_optimizer
@@ -0,0 +1,72 @@
+#include "Catch2/catch_amalgamated.hpp"
+#include "expression_arena.h"
+#include "expression_rewrite.h"
+#include "expression_utils.h"
+
+namespace predicate_optimizer {
+namespace {
+// Upstream resource which counts the bytes requested by the arena.
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocatedBytes{0};
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        allocatedBytes += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+Expression makeFilter() {
+    auto or1 = makeOr({makeEq("a", "1"), makeNot(makeAnd({makeGt("b", "2"), makeLt("c", "3")}))});
+    auto or2 = makeOr({makeIn("d", {"4", "5"}), makeEq("e", "6")});
+    return makeAnd({std::move(or1), std::move(or2)});
+}
+}  // namespace
+
+TEST_CASE("Expression arena", "") {
+    const auto expectedExpr = transformToDNF(removeNotExpressions(makeFilter()));
+
+    SECTION("Nodes are allocated from the arena") {
+        CountingResource upstream{};
+        Expression result{};
+        {
+            ExpressionArena arena{256, &upstream};
+            {
+                ExpressionArena::Scope scope{arena};
+                auto expr = transformToDNF(removeNotExpressions(makeFilter()));
+                REQUIRE(expectedExpr == expr);
+                REQUIRE(upstream.allocatedBytes > 0);
+
+                result = copyToHeap(expr);
+            }
+            const size_t allocatedBytes = upstream.allocatedBytes;
+            auto heapExpr = makeFilter();
+            REQUIRE(allocatedBytes == upstream.allocatedBytes);
+        }
+
+        REQUIRE(expectedExpr == result);
+    }
+
+    SECTION("Nested scopes") {
+        ExpressionArena outer{};
+        ExpressionArena inner{};
+        ExpressionArena::Scope outerScope{outer};
+        auto outerExpr = makeFilter();
+        {
+            ExpressionArena::Scope innerScope{inner};
+            auto innerExpr = outerExpr;
+            REQUIRE(innerExpr == outerExpr);
+        }
+        REQUIRE(transformToDNF(removeNotExpressions(std::move(outerExpr))) == expectedExpr);
+    }
+}
+}  // namespace predicate_optimizer
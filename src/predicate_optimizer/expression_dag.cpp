@@ -0,0 +1,135 @@
+#include "predicate_optimizer/expression_dag.h"
+
+#include <stdexcept>
+
+namespace predicate_optimizer {
+namespace {
+struct InternVisitor {
+    DagExpression operator()(const Expression&, const LogicalExpression& expr) {
+        std::vector<DagExpression> children{};
+        children.reserve(expr.children.size());
+        for (const auto& child : expr.children) {
+            children.emplace_back(child.visit(*this));
+        }
+        return pool.makeLogical(expr.op, std::move(children));
+    }
+
+    DagExpression operator()(const Expression& e, const ComparisonExpression&) {
+        return pool.makeLeaf(e);
+    }
+
+    DagExpression operator()(const Expression& e, const InExpression&) {
+        return pool.makeLeaf(e);
+    }
+
+    DagExpression operator()(const Expression&, const NotExpression& expr) {
+        return pool.makeNot(expr.child.visit(*this));
+    }
+
+    ExpressionPool& pool;
+};
+
+struct IsLeafVisitor {
+    bool operator()(const Expression&, const LogicalExpression&) const {
+        return false;
+    }
+
+    bool operator()(const Expression&, const ComparisonExpression&) const {
+        return true;
+    }
+
+    bool operator()(const Expression&, const InExpression&) const {
+        return true;
+    }
+
+    bool operator()(const Expression&, const NotExpression&) const {
+        return false;
+    }
+};
+}  // namespace
+
+bool DagNode::operator==(const DagNode& other) const {
+    if (kind != other.kind || hash != other.hash) {
+        return false;
+    }
+
+    switch (kind) {
+        case DagNodeKind::Logical:
+            return op == other.op && children == other.children;
+        case DagNodeKind::Not:
+            return children == other.children;
+        case DagNodeKind::Leaf:
+            return leaf == other.leaf;
+    }
+    __builtin_unreachable();
+}
+
+Expression DagExpression::toExpression() const {
+    switch (_node->kind) {
+        case DagNodeKind::Logical: {
+            std::vector<Expression> children{};
+            children.reserve(_node->children.size());
+            for (const auto& child : _node->children) {
+                children.emplace_back(child.toExpression());
+            }
+            return Expression::make<LogicalExpression>(_node->op, std::move(children));
+        }
+        case DagNodeKind::Not:
+            return Expression::make<NotExpression>(_node->children.front().toExpression());
+        case DagNodeKind::Leaf:
+            return _node->leaf;
+    }
+    __builtin_unreachable();
+}
+
+DagExpression ExpressionPool::intern(const Expression& expr) {
+    return expr.visit(InternVisitor{*this});
+}
+
+DagExpression ExpressionPool::makeLogical(LogicalOperator op, std::vector<DagExpression> children) {
+    std::size_t seed = 1823;
+    std::hash_combine(seed, op);
+    std::hash_combine(seed, children);
+    return insert(DagNode{DagNodeKind::Logical, op, std::move(children), {}, seed});
+}
+
+DagExpression ExpressionPool::makeNot(DagExpression child) {
+    std::size_t seed = 3821;
+    std::hash_combine(seed, child);
+    return insert(DagNode{DagNodeKind::Not, LogicalOperator::And, {child}, {}, seed});
+}
+
+DagExpression ExpressionPool::makeLeaf(Expression leaf) {
+    if (!leaf.visit(IsLeafVisitor{})) {
+        throw std::runtime_error("Only comparison and $in expressions can be DAG leaves");
+    }
+
+    const std::size_t seed = std::hash<Expression>{}(leaf);
+    return insert(DagNode{DagNodeKind::Leaf, LogicalOperator::And, {}, std::move(leaf), seed});
+}
+
+DagExpression ExpressionPool::insert(DagNode node) {
+    auto pos = _index.find(&node);
+    if (pos != _index.end()) {
+        return DagExpression{*pos};
+    }
+
+    const DagNode* inserted = &_nodes.emplace_back(std::move(node));
+    _index.insert(inserted);
+    return DagExpression{inserted};
+}
+
+std::unordered_map<const DagNode*, size_t> countReferences(DagExpression root) {
+    std::unordered_map<const DagNode*, size_t> references{};
+    std::vector<DagExpression> stack{root};
+    while (!stack.empty()) {
+        const auto node = stack.back();
+        stack.pop_back();
+        // The children of a node are counted on its first reference only.
+        if (++references[&*node] == 1) {
+            stack.insert(stack.end(), node->children.begin(), node->children.end());
+        }
+    }
+    return references;
+}
+}  // namespace predicate_optimizer
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "predicate_optimizer/expression.h"
+#include <cstddef>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace predicate_optimizer {
+struct DagNode;
+
+/**
+ * Handle to a node of a hash-consed expression DAG owned by an ExpressionPool. Structurally equal
+ * expressions of one pool share one node, so that equality is a pointer comparison and the hash is
+ * computed once, when the node is created. Handles are valid as long as their pool.
+ */
+class DagExpression {
+public:
+    const DagNode& operator*() const noexcept {
+        return *_node;
+    }
+
+    const DagNode* operator->() const noexcept {
+        return _node;
+    }
+
+    bool operator==(const DagExpression& other) const noexcept {
+        return _node == other._node;
+    }
+
+    std::size_t hash() const noexcept;
+
+    /* Expand the DAG under the node to an expression tree. */
+    Expression toExpression() const;
+
+private:
+    friend class ExpressionPool;
+
+    explicit DagExpression(const DagNode* node) : _node(node) {}
+
+    const DagNode* _node;
+};
+
+enum class DagNodeKind { Logical, Not, Leaf };
+
+/**
+ * Immutable node of the DAG. Logical and $not nodes refer to their children by handle, leaves hold
+ * the comparison or $in expression.
+ */
+struct DagNode {
+    DagNodeKind kind;
+    // Operator of a logical node.
+    LogicalOperator op{LogicalOperator::And};
+    // Children of a logical node, or the only child of a $not node.
+    std::vector<DagExpression> children{};
+    // Comparison or $in expression of a leaf, empty for other nodes.
+    Expression leaf{};
+    std::size_t hash{0};
+
+    // Nodes are compared shallowly, the children are equal if they are the same nodes.
+    bool operator==(const DagNode& other) const;
+};
+
+inline std::size_t DagExpression::hash() const noexcept {
+    return _node->hash;
+}
+
+/**
+ * Hash-consing table of expression nodes. Every node is created once: making a node equal to an
+ * existing one returns the existing node, so that repeated subtrees of the interned expressions are
+ * stored and hashed once.
+ */
+class ExpressionPool {
+public:
+    ExpressionPool() {}
+
+    ExpressionPool(const ExpressionPool&) = delete;
+    ExpressionPool& operator=(const ExpressionPool&) = delete;
+
+    DagExpression intern(const Expression& expr);
+
+    DagExpression makeLogical(LogicalOperator op, std::vector<DagExpression> children);
+    DagExpression makeNot(DagExpression child);
+    // Make a leaf of a comparison or $in expression, throws on other expressions.
+    DagExpression makeLeaf(Expression leaf);
+
+    // Number of distinct nodes.
+    size_t size() const {
+        return _nodes.size();
+    }
+
+private:
+    DagExpression insert(DagNode node);
+
+    struct NodeHash {
+        std::size_t operator()(const DagNode* node) const noexcept {
+            return node->hash;
+        }
+    };
+
+    struct NodeEqual {
+        bool operator()(const DagNode* lhs, const DagNode* rhs) const {
+            return *lhs == *rhs;
+        }
+    };
+
+    // Deque keeps the nodes in place, the handles point to them.
+    std::deque<DagNode> _nodes;
+    std::unordered_set<const DagNode*, NodeHash, NodeEqual> _index;
+};
+
+/* Number of references to every node of the DAG under the root, counting the root once. The
+ * nodes referred to more than once are the shared subtrees of the expression. */
+std::unordered_map<const DagNode*, size_t> countReferences(DagExpression root);
+}  // namespace predicate_optimizer
+
+namespace std {
+template <>
+struct hash<predicate_optimizer::DagExpression> {
+    using argument_type = predicate_optimizer::DagExpression;
+    using result_type = std::size_t;
+
+    result_type operator()(const argument_type& expr) const noexcept {
+        return expr.hash();
+    }
+};
+}  // namespace std
@@ -0,0 +1,61 @@
+#include "Catch2/catch_amalgamated.hpp"
+#include "expression_dag.h"
+#include "expression_utils.h"
+
+namespace predicate_optimizer {
+TEST_CASE("Hash-consed expressions", "") {
+    ExpressionPool pool{};
+
+    auto makeSubtree = []() {
+        return makeOr({makeEq("a", "1"), makeAnd({makeGt("b", "2"), makeIn("c", {"3", "4"})})});
+    };
+
+    SECTION("Equal expressions share one node") {
+        auto lhs = pool.intern(makeSubtree());
+        auto rhs = pool.intern(makeSubtree());
+        REQUIRE(lhs == rhs);
+        REQUIRE(&*lhs == &*rhs);
+        REQUIRE(std::hash<DagExpression>{}(lhs) == std::hash<DagExpression>{}(rhs));
+
+        auto other = pool.intern(makeOr({makeEq("a", "1"), makeGt("b", "2")}));
+        REQUIRE(lhs != other);
+    }
+
+    SECTION("Repeated subtrees are stored once") {
+        auto expr = makeAnd({makeSubtree(), makeNot(makeSubtree()), makeSubtree()});
+        auto dag = pool.intern(expr);
+
+        // 3 leaves, $and and $or of the subtree, $not, the root.
+        REQUIRE(pool.size() == 7);
+        REQUIRE(dag->children.size() == 3);
+        REQUIRE(dag->children[0] == dag->children[2]);
+        REQUIRE(dag->children[1]->children.front() == dag->children[0]);
+
+        auto references = countReferences(dag);
+        REQUIRE(references.size() == 7);
+        REQUIRE(references.at(&*dag) == 1);
+        REQUIRE(references.at(&*dag->children[0]) == 3);
+        REQUIRE(references.at(&*dag->children[1]) == 1);
+        // The leaves of the subtree are counted through their parent once.
+        REQUIRE(references.at(&*dag->children[0]->children.front()) == 1);
+    }
+
+    SECTION("Round trip") {
+        auto expr = makeAnd({makeSubtree(), makeNot(makeSubtree()), makeNotIn("d", {"5"})});
+        REQUIRE(expr == pool.intern(expr).toExpression());
+    }
+
+    SECTION("Order of children matters") {
+        auto lhs = pool.makeLogical(LogicalOperator::And,
+                                    {pool.intern(makeEq("a", "1")), pool.intern(makeEq("b", "1"))});
+        auto rhs = pool.makeLogical(LogicalOperator::And,
+                                    {pool.intern(makeEq("b", "1")), pool.intern(makeEq("a", "1"))});
+        REQUIRE(lhs != rhs);
+        REQUIRE(lhs != pool.makeLogical(LogicalOperator::Or, lhs->children));
+    }
+
+    SECTION("Only predicates are leaves") {
+        REQUIRE_THROWS_AS(pool.makeLeaf(makeSubtree()), std::runtime_error);
+    }
+}
+}  // namespace predicate_optimizer
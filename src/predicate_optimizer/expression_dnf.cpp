@@ -1,63 +1,61 @@
 #include "predicate_optimizer/expression_dnf.h"
 #include "predicate_optimizer/expression.h"
+#include "predicate_optimizer/expression_dag.h"
+#include "predicate_optimizer/flat_expression.h"
+#include "predicate_optimizer/maxterm_absorption.h"
+#include "predicate_optimizer/predicate_implications.h"
 
 namespace predicate_optimizer {
 namespace {
-struct NormalFormVisitor {
-    Maxterm operator()(const Expression&, const LogicalExpression& expr) {
-        switch (expr.op) {
-            case LogicalOperator::And:
-                return processAnd(expr);
-            case LogicalOperator::Or:
-                return processOr(expr);
-        }
-    }
+// Assigns a bit index to every distinct leaf predicate of the expression. The predicates are
+// numbered in the visiting order, and the leaves are recorded so that NormalFormVisitor can build
+// the normal form with bitsets sized once the total number of predicates is known. The predicates
+// are keyed by their pool handles, so that a lookup hashes and compares pointers.
+struct PredicateCollector {
+    using Literal = std::pair<size_t, bool>;
 
-    Maxterm operator()(const Expression& e, const ComparisonExpression& expr) {
-        if (isGreaterEqual(expr)) {
-            return processLeafPredicate(e, true);
-        } else {
-            return processLeafPredicate(makeGreaterEqual(expr), false);
-        }
-    }
+    explicit PredicateCollector(ExpressionPool& pool) : _pool(pool) {}
 
-    Maxterm operator()(const Expression& e, const InExpression& expr) {
-        switch (expr.op) {
-            case InOperator::In:
-                return processLeafPredicate(e, true);
-            case InOperator::NotIn:
-                return processLeafPredicate(
-                    Expression::make<InExpression>(InOperator::In, expr.path, expr.values), false);
+    // Collect the leaves of the DAG under the node, a shared subtree is visited on its first
+    // reference only.
+    void collect(DagExpression node) {
+        if (++_references[&*node] > 1) {
+            return;
+        }
+        if (node->kind == DagNodeKind::Leaf) {
+            _literals.emplace(&*node, getLiteral(node));
+            return;
+        }
+        for (const auto& child : node->children) {
+            collect(child);
         }
     }
 
-    Maxterm operator()(const Expression&, const NotExpression& expr) {
-        return ~expr.child.visit(*this);
+    // Collect a leaf of a flat expression, the leaves are visited in order.
+    void collectFlat(Expression leaf) {
+        _leaves.push_back(getLiteral(_pool.makeLeaf(std::move(leaf))));
     }
 
-    Maxterm processAnd(const LogicalExpression& expr) {
-        if (expr.children.empty()) {
-            return {};
-        }
-        auto result = expr.children.front().visit(*this);
-        for (size_t i = 1; i < expr.children.size(); ++i) {
-            result &= expr.children[i].visit(*this);
+    // The literal of a comparison or $in leaf: the bit of its GE, GT, EQ or $in form, set if the
+    // leaf is in that form.
+    Literal getLiteral(DagExpression leaf) {
+        if (const auto* expr = leaf->leaf.cast<ComparisonExpression>()) {
+            if (isGreaterEqual(*expr)) {
+                return {getExpressionIndex(leaf), true};
+            }
+            return {getExpressionIndex(_pool.makeLeaf(makeGreaterEqual(*expr))), false};
         }
-        return result;
-    }
 
-    Maxterm processOr(const LogicalExpression& expr) {
-        assert(expr.op == LogicalOperator::Or);
-        Maxterm result{};
-        for (const auto& child : expr.children) {
-            result |= child.visit(*this);
+        const auto& expr = *leaf->leaf.cast<InExpression>();
+        switch (expr.op) {
+            case InOperator::In:
+                return {getExpressionIndex(leaf), true};
+            case InOperator::NotIn:
+                return {getExpressionIndex(_pool.makeLeaf(Expression::make<InExpression>(
+                            InOperator::In, expr.path, expr.values))),
+                        false};
         }
-        return result;
-    }
-
-    Maxterm processLeafPredicate(const Expression& expr, bool isSet) {
-        auto bitIndex = getExpressionIndex(expr);
-        return {Minterm(bitIndex, isSet)};
+        __builtin_unreachable();
     }
 
     bool isGreaterEqual(const ComparisonExpression& expr) const {
@@ -75,6 +73,7 @@ struct NormalFormVisitor {
             case ComparisonOperator::NE:
                 return false;
         }
+        __builtin_unreachable();
     }
 
     Expression makeGreaterEqual(const ComparisonExpression& expr) const {
@@ -95,32 +94,277 @@ struct NormalFormVisitor {
                 return Expression::make<ComparisonExpression>(
                     ComparisonOperator::EQ, expr.path, expr.value);
         }
+        __builtin_unreachable();
     }
 
-    // maps n expression to the index of its corresponding bit.
-    std::unordered_map<Expression, size_t> _map;
+    ExpressionPool& _pool;
+
+    // maps the handle of a predicate to the index of its corresponding bit.
+    std::unordered_map<DagExpression, size_t> _map;
 
     std::vector<Expression> _expressions;
 
-    size_t getExpressionIndex(const Expression& expr) {
-        auto pos = _map.find(expr);
-        if (pos != _map.end()) {
-            return pos->second;
+    // Number of references to every collected node of a DAG.
+    std::unordered_map<const DagNode*, size_t> _references;
+
+    // Literal of every leaf node of a DAG.
+    std::unordered_map<const DagNode*, Literal> _literals;
+
+    // Literal of every leaf of a flat expression in the visiting order.
+    std::vector<Literal> _leaves;
+
+    size_t getExpressionIndex(DagExpression expr) {
+        auto [pos, isInserted] = _map.try_emplace(expr, _expressions.size());
+        if (isInserted) {
+            _expressions.emplace_back(expr->leaf);
+        }
+        return pos->second;
+    }
+};
+
+template <typename BitsetT>
+struct NormalFormVisitor {
+    using Maxterm = BasicMaxterm<BitsetT>;
+    using Minterm = BasicMinterm<BitsetT>;
+
+    NormalFormVisitor(const PredicateCollector& collector,
+                      const NormalFormOptions& options,
+                      std::vector<Minterm> impliedLiterals)
+        : _collector(collector),
+          _numPredicates(collector._expressions.size()),
+          _options(options),
+          _impliedLiterals(std::move(impliedLiterals)),
+          _tracker(options.budget) {}
+
+    // Build the normal form of the DAG under the node. The normal form of a shared subtree is built
+    // once and copied for its other references.
+    Maxterm processDag(DagExpression node) {
+        const bool isShared = _collector._references.at(&*node) > 1;
+        if (isShared) {
+            auto pos = _shared.find(&*node);
+            if (pos != _shared.end()) {
+                return charge(pos->second);
+            }
+        }
+
+        auto result = processDagNode(*node);
+        if (isShared) {
+            _shared.emplace(&*node, result);
+        }
+        return result;
+    }
+
+    Maxterm processDagNode(const DagNode& node) {
+        auto visitChild = [&](size_t i) { return processDag(node.children[i]); };
+        switch (node.kind) {
+            case DagNodeKind::Logical:
+                switch (node.op) {
+                    case LogicalOperator::And:
+                        return processAnd(node.children.size(), visitChild);
+                    case LogicalOperator::Or:
+                        return processOr(node.children.size(), visitChild);
+                }
+            case DagNodeKind::Not:
+                return processNot(processDag(node.children.front()));
+            case DagNodeKind::Leaf:
+                return processLeafPredicate(_collector._literals.at(&node));
+        }
+        __builtin_unreachable();
+    }
+
+    // Build the normal form of the subtree of the flat expression rooted at the given node.
+    Maxterm processFlat(const FlatExpression& expr, size_t index) {
+        const auto& node = expr.nodes[index];
+        size_t child = index + 1;
+        auto visitChild = [&](size_t) {
+            auto result = processFlat(expr, child);
+            child += expr.nodes[child].size;
+            return result;
+        };
+
+        switch (node.kind) {
+            case FlatNodeKind::And:
+                return processAnd(node.arg, visitChild);
+            case FlatNodeKind::Or:
+                return processOr(node.arg, visitChild);
+            case FlatNodeKind::Not:
+                return processNot(processFlat(expr, index + 1));
+            case FlatNodeKind::Comparison:
+                [[fallthrough]];
+            case FlatNodeKind::In:
+                return processLeafPredicate(_collector._leaves.at(_nextLeaf++));
+        }
+        __builtin_unreachable();
+    }
+
+    Maxterm processNot(Maxterm child) {
+        // The complement is the product of the complements of the minterms, charged before it is
+        // built, the absorption only makes it smaller.
+        size_t numMinterms = 1;
+        for (const auto& minterm : child.minterms) {
+            numMinterms = saturatingMultiply(numMinterms, minterm.mask.count());
+        }
+        chargeMinterms(numMinterms);
+
+        if (_options.absorb) {
+            return charge(removeContradictions(absorbingComplement(child)));
+        }
+        return removeContradictions(~child);
+    }
+
+    // The children are visited in order by visitChild(0), ..., visitChild(numChildren - 1).
+    template <typename VisitChild>
+    Maxterm processAnd(size_t numChildren, VisitChild&& visitChild) {
+        if (numChildren == 0) {
+            return {};
+        }
+        auto result = visitChild(0);
+        for (size_t i = 1; i < numChildren; ++i) {
+            auto child = visitChild(i);
+            chargeMinterms(saturatingMultiply(result.minterms.size(), child.minterms.size()));
+            if (_options.absorb) {
+                result = charge(removeContradictions(absorbingProduct(result, child)));
+            } else {
+                result &= child;
+                result = removeContradictions(std::move(result));
+            }
+        }
+        return result;
+    }
+
+    template <typename VisitChild>
+    Maxterm processOr(size_t numChildren, VisitChild&& visitChild) {
+        if (_options.absorb) {
+            AbsorbingMaxterm<BitsetT> result{};
+            for (size_t i = 0; i < numChildren; ++i) {
+                result.insert(visitChild(i));
+            }
+            return charge(std::move(result).release());
+        }
+
+        Maxterm result{};
+        for (size_t i = 0; i < numChildren; ++i) {
+            result |= visitChild(i);
+        }
+        return charge(std::move(result));
+    }
+
+    // Remove the minterms contradicting the implications of their own literals, see
+    // NormalFormOptions::pruneContradictions.
+    Maxterm removeContradictions(Maxterm maxterm) const {
+        if (!_impliedLiterals.empty()) {
+            std::erase_if(maxterm.minterms, [&](const Minterm& minterm) {
+                return isContradictory(minterm, _impliedLiterals);
+            });
+        }
+        return maxterm;
+    }
+
+    // Check that a maxterm of the given number of minterms fits the budget.
+    void chargeMinterms(size_t numMinterms) {
+        size_t mintermBytes = sizeof(Minterm);
+        if constexpr (std::is_same_v<BitsetT, Bitset>) {
+            mintermBytes += 2 * Bitset::wordsFor(_numPredicates) * sizeof(Bitset::Word);
         }
+        _tracker.charge(numMinterms, saturatingMultiply(numMinterms, mintermBytes));
+    }
+
+    Maxterm charge(Maxterm maxterm) {
+        chargeMinterms(maxterm.minterms.size());
+        return maxterm;
+    }
 
-        size_t index = _expressions.size();
-        _expressions.emplace_back(expr);
-        _map[expr] = index;
-        return index;
+    Maxterm processLeafPredicate(PredicateCollector::Literal literal) {
+        const auto [bitIndex, isSet] = literal;
+        auto minterm = Minterm::withSize(_numPredicates);
+        minterm.set(bitIndex, isSet);
+        return {std::move(minterm)};
     }
+
+    const PredicateCollector& _collector;
+    const size_t _numPredicates;
+    const NormalFormOptions& _options;
+    // Implied literals of every literal, empty if contradictions are not pruned.
+    const std::vector<Minterm> _impliedLiterals;
+    ExpansionBudgetTracker _tracker;
+    // Normal forms of the shared subtrees of a DAG.
+    std::unordered_map<const DagNode*, Maxterm> _shared;
+    // Next leaf of a flat expression.
+    size_t _nextLeaf{0};
 };
 
+// Build the normal form with the visitor of the bitset type fitting the collected predicates. The
+// function builds the maxterm by the given visitor.
+template <typename BuildMaxterm>
+NormalFormResult buildNormalForm(PredicateCollector& collector,
+                                 const NormalFormOptions& options,
+                                 BuildMaxterm&& buildMaxterm) {
+    const size_t numPredicates = collector._expressions.size();
+    try {
+        auto maxterm = dispatchByWidth(numPredicates, [&](auto bitsetType) {
+            using BitsetT = typename decltype(bitsetType)::type;
+            std::vector<BasicMinterm<BitsetT>> impliedLiterals{};
+            if (options.pruneContradictions) {
+                PredicateImplications implications{collector._expressions};
+                if (!implications.empty()) {
+                    impliedLiterals = implications.impliedLiterals<BitsetT>();
+                }
+            }
+            NormalFormVisitor<BitsetT> visitor{collector, options, std::move(impliedLiterals)};
+            return maxterm_cast<Bitset>(buildMaxterm(visitor));
+        });
+        return {ExpansionStatus::Ok, std::move(maxterm), std::move(collector._expressions)};
+    } catch (const ExpansionBudgetExceeded& ex) {
+        return {ex.status, {}, std::move(collector._expressions)};
+    }
+}
+
+std::pair<Maxterm, std::vector<Expression>> unwrap(NormalFormResult result) {
+    if (result.status != ExpansionStatus::Ok) {
+        throw ExpansionBudgetExceeded(result.status);
+    }
+    return {std::move(result.maxterm), std::move(result.expressions)};
+}
 }  // namespace
 
-std::pair<Maxterm, std::vector<Expression>> transformToNormalForm(Expression expr) {
-    NormalFormVisitor visitor{};
-    auto maxterm = expr.visit(visitor);
-    return {maxterm, visitor._expressions};
+NormalFormResult tryTransformToNormalForm(Expression expr, const NormalFormOptions& options) {
+    ExpressionPool pool{};
+    const auto root = pool.intern(expr);
+    PredicateCollector collector{pool};
+    collector.collect(root);
+
+    return buildNormalForm(
+        collector, options, [&](auto& visitor) { return visitor.processDag(root); });
+}
+
+NormalFormResult tryTransformToNormalForm(const FlatExpression& expr,
+                                          const NormalFormOptions& options) {
+    if (expr.nodes.empty()) {
+        throw std::runtime_error("FlatExpression is empty");
+    }
+
+    // The leaves of the flat expression are stored in the visiting order of the tree.
+    ExpressionPool pool{};
+    PredicateCollector collector{pool};
+    for (size_t i = 0; i < expr.nodes.size(); ++i) {
+        const auto kind = expr.nodes[i].kind;
+        if (kind == FlatNodeKind::Comparison || kind == FlatNodeKind::In) {
+            collector.collectFlat(expr.leafExpression(i));
+        }
+    }
+
+    return buildNormalForm(
+        collector, options, [&](auto& visitor) { return visitor.processFlat(expr, 0); });
+}
+
+std::pair<Maxterm, std::vector<Expression>> transformToNormalForm(
+    Expression expr, const NormalFormOptions& options) {
+    return unwrap(tryTransformToNormalForm(std::move(expr), options));
+}
+
+std::pair<Maxterm, std::vector<Expression>> transformToNormalForm(
+    const FlatExpression& expr, const NormalFormOptions& options) {
+    return unwrap(tryTransformToNormalForm(expr, options));
 }
 
 }  // namespace predicate_optimizer
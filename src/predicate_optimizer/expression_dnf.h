@@ -1,12 +1,46 @@
 #pragma once
 
 #include "predicate_optimizer/bitset_algebra.h"
+#include "predicate_optimizer/expansion_budget.h"
 #include "predicate_optimizer/expression.h"
+#include "predicate_optimizer/flat_expression.h"
 #include <unordered_map>
 #include <vector>
 
 namespace predicate_optimizer {
+struct NormalFormOptions {
+    // Remove duplicate and absorbed minterms (a | ab == a) while the normal form is built.
+    bool absorb{false};
+
+    // Remove the minterms whose literals contradict each other, e.g. a > 5 && a < 3, while the
+    // normal form is built, see PredicateImplications.
+    bool pruneContradictions{false};
+
+    // Limits of the expansion, see tryTransformToNormalForm.
+    ExpansionBudget budget{};
+};
+
+struct NormalFormResult {
+    ExpansionStatus status;
+    // The normal form, empty if the budget was exhausted.
+    Maxterm maxterm;
+    // Predicates corresponding to the bits of the minterms.
+    std::vector<Expression> expressions;
+};
+
 /* Transform the expression to disjunctive normal form. This function does not accept boolean
- * expressions containing negations.*/
-std::pair<Maxterm, std::vector<Expression>> transformToNormalForm(Expression expr);
+ * expressions containing negations. Throws ExpansionBudgetExceeded if the budget of the options is
+ * exhausted.*/
+std::pair<Maxterm, std::vector<Expression>> transformToNormalForm(
+    Expression expr, const NormalFormOptions& options = {});
+
+/* Same as transformToNormalForm, but stops the expansion cleanly when the budget is exhausted and
+ * reports it in the status of the result.*/
+NormalFormResult tryTransformToNormalForm(Expression expr, const NormalFormOptions& options);
+
+/* Same as transformToNormalForm and tryTransformToNormalForm for the flat representation.*/
+std::pair<Maxterm, std::vector<Expression>> transformToNormalForm(
+    const FlatExpression& expr, const NormalFormOptions& options = {});
+NormalFormResult tryTransformToNormalForm(const FlatExpression& expr,
+                                          const NormalFormOptions& options);
 }  // namespace predicate_optimizer
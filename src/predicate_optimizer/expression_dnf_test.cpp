@@ -2,6 +2,7 @@
 #include "predicate_optimizer/expression.h"
 #include "predicate_optimizer/expression_dnf.h"
 #include "predicate_optimizer/expression_utils.h"
+#include "predicate_optimizer/flat_expression.h"
 
 namespace predicate_optimizer {
 TEST_CASE("DNF", "") {
@@ -205,6 +206,20 @@ TEST_CASE("DNF", "") {
         REQUIRE(expectedExpressions == actualMap);
     }
 
+    SECTION("(a in [1, 2]) & (a not in [2, 1])") {
+        auto expr = makeAnd({
+            makeIn("a", {"1", "2"}),
+            makeNotIn("a", {"2", "1"}),
+        });
+        std::vector<Expression> expectedExpressions{
+            makeIn("a", {"1", "2"}),
+        };
+
+        auto [actualResult, actualMap] = transformToNormalForm(expr);
+        REQUIRE(actualResult.minterms.empty());
+        REQUIRE(expectedExpressions == actualMap);
+    }
+
     SECTION("(a not in [1, 2]) | (a in [1, 2, 3])") {
         auto expr = makeOr({
             makeNotIn("a", {"1", "2"}),
@@ -259,5 +274,164 @@ TEST_CASE("DNF", "") {
         REQUIRE(expectedResult == actualResult);
         REQUIRE(expectedExpressions == actualMap);
     }
+
+    SECTION("a0 > 0 & a1 > 1 & ... & a39 > 39") {
+        std::vector<Expression> children{};
+        std::vector<Expression> expectedExpressions{};
+        Minterm expectedMinterm{};
+        for (size_t i = 0; i < 40; ++i) {
+            auto path = "a" + std::to_string(i);
+            children.emplace_back(makeGt(path, std::to_string(i)));
+            expectedExpressions.emplace_back(makeGt(path, std::to_string(i)));
+            expectedMinterm.set(i, true);
+        }
+        Maxterm expectedResult{expectedMinterm};
+
+        auto [actualResult, actualMap] = transformToNormalForm(makeAnd(std::move(children)));
+        REQUIRE(expectedResult == actualResult);
+        REQUIRE(expectedExpressions == actualMap);
+    }
+
+    SECTION("~(a > 1 | b > 1) & (a < 2 | b < 2) with absorption") {
+        auto expr = makeNot(makeAnd({
+            makeOr({makeGt("a", "1"), makeGt("b", "1")}),
+            makeOr({makeLt("a", "2"), makeLt("b", "2")}),
+        }));
+
+        Maxterm expectedResult{
+            {"0000", "0011"},
+            {"1100", "1100"},
+        };
+
+        auto [actualResult, actualMap] = transformToNormalForm(expr, {.absorb = true});
+        REQUIRE(expectedResult == actualResult);
+    }
+
+    SECTION("(a | b) & (a | c) & (a | d) with absorption") {
+        auto expr = makeAnd({
+            makeOr({makeEq("a", "1"), makeEq("b", "1")}),
+            makeOr({makeEq("a", "1"), makeEq("c", "1")}),
+            makeOr({makeEq("a", "1"), makeEq("d", "1")}),
+        });
+
+        Maxterm expectedResult{
+            {"0001", "0001"},
+            {"1110", "1110"},
+        };
+
+        auto [actualResult, actualMap] = transformToNormalForm(expr, {.absorb = true});
+        REQUIRE(expectedResult == actualResult);
+    }
+
+    SECTION("(a > 5 | a < 3) & (a < 2 | a > 7) with pruned contradictions") {
+        auto expr = makeAnd({
+            makeOr({makeGt("a", "5"), makeLt("a", "3")}),
+            makeOr({makeLt("a", "2"), makeGt("a", "7")}),
+        });
+
+        // a > 5 & a < 2 and a < 3 & a > 7 are removed.
+        Maxterm expectedResult{
+            {"1001", "1001"},
+            {"0000", "0110"},
+        };
+
+        REQUIRE(transformToNormalForm(expr).first.minterms.size() == 4);
+        REQUIRE(transformToNormalForm(expr, {.pruneContradictions = true}).first ==
+                expectedResult);
+        REQUIRE(transformToNormalForm(expr, {.absorb = true, .pruneContradictions = true}).first ==
+                expectedResult);
+        REQUIRE(transformToNormalForm(FlatExpression{expr}, {.pruneContradictions = true}).first ==
+                expectedResult);
+    }
+
+    SECTION("~(a <= 5 & a != 7) & a < 6 with pruned contradictions") {
+        auto expr = makeAnd({
+            makeNot(makeAnd({makeLe("a", "5"), makeNe("a", "7")})),
+            makeLt("a", "6"),
+        });
+
+        // a > 5 & a < 6 is kept, only a == 7 & a < 6 is removed.
+        Maxterm expectedResult{{"001", "101"}};
+
+        auto [actualResult, actualMap] = transformToNormalForm(expr, {.pruneContradictions = true});
+        REQUIRE(expectedResult == actualResult);
+    }
+
+    SECTION("Shared subtrees") {
+        auto makeSubtree = []() {
+            return makeOr({makeAnd({makeGt("a", "1"), makeLt("b", "2")}), makeEq("c", "3")});
+        };
+        auto expr = makeOr({
+            makeAnd({makeSubtree(), makeNot(makeSubtree())}),
+            makeAnd({makeSubtree(), makeGe("d", "4")}),
+            makeSubtree(),
+        });
+
+        // The normal form of the tree is built once for the subtree, the flat expression is not
+        // shared.
+        for (const auto& options : {NormalFormOptions{}, NormalFormOptions{.absorb = true}}) {
+            auto [actualResult, actualMap] = transformToNormalForm(expr, options);
+            auto [flatResult, flatMap] = transformToNormalForm(FlatExpression{expr}, options);
+            REQUIRE(flatResult == actualResult);
+            REQUIRE(flatMap == actualMap);
+            REQUIRE(actualMap.size() == 4);
+        }
+    }
+}
+
+TEST_CASE("Normal form budget", "") {
+    // $and of ten 5-way $or expands to 5^10 minterms.
+    std::vector<Expression> ors{};
+    for (size_t i = 0; i < 10; ++i) {
+        std::vector<Expression> children{};
+        for (size_t j = 0; j < 5; ++j) {
+            children.emplace_back(makeEq("a" + std::to_string(i), std::to_string(j)));
+        }
+        ors.emplace_back(makeOr(std::move(children)));
+    }
+    auto expr = makeAnd(std::move(ors));
+
+    SECTION("minterm limit") {
+        NormalFormOptions options{.budget = {.maxMinterms = 10000}};
+        auto result = tryTransformToNormalForm(expr, options);
+        REQUIRE(result.status == ExpansionStatus::MintermLimitExceeded);
+        REQUIRE(result.maxterm.minterms.empty());
+        REQUIRE(result.expressions.size() == 50);
+
+        REQUIRE_THROWS_AS(transformToNormalForm(expr, options), ExpansionBudgetExceeded);
+    }
+
+    SECTION("minterm limit with absorption") {
+        NormalFormOptions options{.absorb = true, .budget = {.maxMinterms = 10000}};
+        REQUIRE(tryTransformToNormalForm(expr, options).status ==
+                ExpansionStatus::MintermLimitExceeded);
+
+        // The complement of the $or of ten 5-way $and is a product of 5^10 minterms.
+        std::vector<Expression> ands{};
+        for (size_t i = 0; i < 10; ++i) {
+            std::vector<Expression> children{};
+            for (size_t j = 0; j < 5; ++j) {
+                children.emplace_back(makeEq("b" + std::to_string(i), std::to_string(j)));
+            }
+            ands.emplace_back(makeAnd(std::move(children)));
+        }
+        auto complement = makeNot(makeOr(std::move(ands)));
+        REQUIRE(tryTransformToNormalForm(complement, options).status ==
+                ExpansionStatus::MintermLimitExceeded);
+    }
+
+    SECTION("memory limit") {
+        NormalFormOptions options{.budget = {.maxBytes = 1 << 20}};
+        auto result = tryTransformToNormalForm(expr, options);
+        REQUIRE(result.status == ExpansionStatus::MemoryLimitExceeded);
+    }
+
+    SECTION("within the limits") {
+        NormalFormOptions options{.budget = {.maxMinterms = 100}};
+        auto result = tryTransformToNormalForm(
+            makeAnd({makeOr({makeEq("a", "1"), makeEq("b", "1")}), makeEq("c", "1")}), options);
+        REQUIRE(result.status == ExpansionStatus::Ok);
+        REQUIRE(result.maxterm.minterms.size() == 2);
+    }
 }
 }  // namespace predicate_optimizer
@@ -0,0 +1,64 @@
+#include "predicate_optimizer/expression_reconstruction.h"
+#include "predicate_optimizer/expression_rewrite.h"
+
+namespace predicate_optimizer {
+namespace {
+// Negation of a predicate of the normal form, the leaves are negated by their operators.
+struct PredicateNegation {
+    Expression operator()(const Expression& e, const LogicalExpression&) const {
+        return removeNotExpressions(Expression::make<NotExpression>(e));
+    }
+
+    Expression operator()(const Expression&, const ComparisonExpression& expr) const {
+        return Expression::make<ComparisonExpression>(negate(expr.op), expr.path, expr.value);
+    }
+
+    Expression operator()(const Expression&, const InExpression& expr) const {
+        return Expression::make<InExpression>(negate(expr.op), expr.path, expr.values);
+    }
+
+    Expression operator()(const Expression&, const NotExpression& expr) const {
+        return expr.child;
+    }
+};
+
+Expression makeLogical(LogicalOperator op, std::vector<Expression> children) {
+    if (children.size() == 1) {
+        return std::move(children.front());
+    }
+    return Expression::make<LogicalExpression>(op, std::move(children));
+}
+
+Expression makeConjunction(const Minterm& minterm, const std::vector<Expression>& expressions) {
+    std::vector<Expression> predicates{};
+    predicates.reserve(minterm.mask.count());
+    minterm.mask.forEachSetBit([&](size_t bit) {
+        const auto& predicate = expressions.at(bit);
+        predicates.emplace_back(minterm.bitset[bit] ? predicate
+                                                    : predicate.visit(PredicateNegation{}));
+    });
+    return makeLogical(LogicalOperator::And, std::move(predicates));
+}
+}  // namespace
+
+Expression reconstructExpression(const std::vector<Minterm>& minterms,
+                                 const std::vector<Expression>& expressions) {
+    std::vector<Expression> conjunctions{};
+    conjunctions.reserve(minterms.size());
+    for (const auto& minterm : minterms) {
+        conjunctions.emplace_back(makeConjunction(minterm, expressions));
+    }
+    return makeLogical(LogicalOperator::Or, std::move(conjunctions));
+}
+
+Expression reconstructExpression(const std::vector<QMCResult>& implicants,
+                                 const std::vector<unsigned>& cover,
+                                 const std::vector<Expression>& expressions) {
+    std::vector<Expression> conjunctions{};
+    conjunctions.reserve(cover.size());
+    for (auto index : cover) {
+        conjunctions.emplace_back(makeConjunction(implicants.at(index).minterm, expressions));
+    }
+    return makeLogical(LogicalOperator::Or, std::move(conjunctions));
+}
+}  // namespace predicate_optimizer
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "predicate_optimizer/bitset_algebra.h"
+#include "predicate_optimizer/expression.h"
+#include "predicate_optimizer/quine_mccluskey.h"
+#include <vector>
+
+namespace predicate_optimizer {
+/* Inverse of transformToNormalForm: build the $or of the $ands of the predicates of the minterms.
+ * A set bit is the predicate itself and a cleared bit its negation, so that a GE predicate becomes
+ * LT, EQ becomes NE, GT becomes LE and $in becomes $nin. Logical nodes of a single child are
+ * replaced by the child, an empty minterm is the empty $and (true) and an empty list of minterms
+ * is the empty $or (false).*/
+Expression reconstructExpression(const std::vector<Minterm>& minterms,
+                                 const std::vector<Expression>& expressions);
+
+/* Same as above for the implicants of the given cover, see selectCover.*/
+Expression reconstructExpression(const std::vector<QMCResult>& implicants,
+                                 const std::vector<unsigned>& cover,
+                                 const std::vector<Expression>& expressions);
+}  // namespace predicate_optimizer
@@ -0,0 +1,52 @@
+#include "Catch2/catch_amalgamated.hpp"
+#include "predicate_optimizer/expression_dnf.h"
+#include "predicate_optimizer/expression_reconstruction.h"
+#include "predicate_optimizer/expression_utils.h"
+
+namespace predicate_optimizer {
+TEST_CASE("Expression reconstruction", "") {
+    SECTION("Round trip through the normal form") {
+        auto expr = makeOr({
+            makeAnd({makeLt("a", "5"), makeNe("b", "1")}),
+            makeNotIn("c", {"1", "2"}),
+            makeLe("d", "3"),
+            makeAnd({makeGe("a", "5"), makeIn("c", {"1", "2"}), makeGt("d", "3")}),
+        });
+
+        auto [maxterm, expressions] = transformToNormalForm(expr);
+
+        REQUIRE(reconstructExpression(maxterm.minterms, expressions) == expr);
+    }
+
+    SECTION("Single child nodes are collapsed") {
+        std::vector<Expression> expressions{makeGe("a", "5"), makeEq("b", "1")};
+
+        REQUIRE(reconstructExpression({{"01"_b, "01"_b}}, expressions) == makeGe("a", "5"));
+        REQUIRE(reconstructExpression({{"00"_b, "10"_b}}, expressions) == makeNe("b", "1"));
+        REQUIRE(reconstructExpression({{"01"_b, "11"_b}}, expressions) ==
+                makeAnd({makeGe("a", "5"), makeNe("b", "1")}));
+    }
+
+    SECTION("Constants") {
+        std::vector<Expression> expressions{makeGe("a", "5")};
+
+        REQUIRE(reconstructExpression(std::vector<Minterm>{}, expressions) == makeOr({}));
+        REQUIRE(reconstructExpression({{"0"_b, "0"_b}}, expressions) == makeAnd({}));
+    }
+
+    SECTION("Cover of implicants") {
+        std::vector<Expression> expressions{makeGt("a", "5"), makeIn("b", {"1", "2"})};
+        std::vector<QMCResult> implicants{
+            {"01"_b, "01"_b, {0, 1}},
+            {"00"_b, "11"_b, {2}},
+            {"10"_b, "10"_b, {1, 3}},
+        };
+
+        REQUIRE(reconstructExpression(implicants, {2, 1}, expressions) ==
+                makeOr({
+                    makeIn("b", {"1", "2"}),
+                    makeAnd({makeLe("a", "5"), makeNotIn("b", {"1", "2"})}),
+                }));
+    }
+}
+}  // namespace predicate_optimizer
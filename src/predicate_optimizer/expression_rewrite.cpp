@@ -1,6 +1,45 @@
 #include "expression_rewrite.h"
+#include "expression_dag.h"
 
 namespace predicate_optimizer {
+LogicalOperator negate(LogicalOperator op) {
+    switch (op) {
+        case LogicalOperator::And:
+            return LogicalOperator::Or;
+        case LogicalOperator::Or:
+            return LogicalOperator::And;
+    }
+    __builtin_unreachable();
+}
+
+ComparisonOperator negate(ComparisonOperator op) {
+    switch (op) {
+        case ComparisonOperator::EQ:
+            return ComparisonOperator::NE;
+        case ComparisonOperator::GE:
+            return ComparisonOperator::LT;
+        case ComparisonOperator::GT:
+            return ComparisonOperator::LE;
+        case ComparisonOperator::LE:
+            return ComparisonOperator::GT;
+        case ComparisonOperator::LT:
+            return ComparisonOperator::GE;
+        case ComparisonOperator::NE:
+            return ComparisonOperator::EQ;
+    }
+    __builtin_unreachable();
+}
+
+InOperator negate(InOperator op) {
+    switch (op) {
+        case InOperator::In:
+            return InOperator::NotIn;
+        case InOperator::NotIn:
+            return InOperator::In;
+    }
+    __builtin_unreachable();
+}
+
 namespace {
 struct NotRemoval {
     Expression operator()(const Expression&, LogicalExpression& expr) {
@@ -33,41 +72,6 @@ struct NotRemoval {
     }
 
     bool inNot{false};
-
-    static LogicalOperator negate(LogicalOperator op) {
-        switch (op) {
-            case LogicalOperator::And:
-                return LogicalOperator::Or;
-            case LogicalOperator::Or:
-                return LogicalOperator::And;
-        }
-    }
-
-    static ComparisonOperator negate(ComparisonOperator op) {
-        switch (op) {
-            case ComparisonOperator::EQ:
-                return ComparisonOperator::NE;
-            case ComparisonOperator::GE:
-                return ComparisonOperator::LT;
-            case ComparisonOperator::GT:
-                return ComparisonOperator::LE;
-            case ComparisonOperator::LE:
-                return ComparisonOperator::GT;
-            case ComparisonOperator::LT:
-                return ComparisonOperator::GE;
-            case ComparisonOperator::NE:
-                return ComparisonOperator::EQ;
-        }
-    }
-
-    static InOperator negate(InOperator op) {
-        switch (op) {
-            case InOperator::In:
-                return InOperator::NotIn;
-            case InOperator::NotIn:
-                return InOperator::In;
-        }
-    }
 };
 
 void move(std::vector<Expression>& target, std::vector<Expression>& source) {
@@ -79,64 +83,140 @@ void move(std::vector<Expression>& target, std::vector<Expression>& source) {
     }
 }
 
+/**
+ * DNF transformation of an expression tree. The node of the expression in the DAG of its pool is
+ * passed along with every logical expression, so that the DNF of a repeated subtree is built once
+ * and copied for its other occurrences.
+ */
 struct DNFTransformer {
+    DNFTransformer(ExpansionBudgetTracker& tracker, DagExpression root)
+        : tracker(tracker), root(root), references(countReferences(root)) {}
+
     Expression operator()(const Expression&, LogicalExpression& expr) {
-        return processLogicalExpression(expr);
+        return processLogicalExpression(expr, root);
     }
 
-    Expression processLogicalExpression(LogicalExpression& expr) {
-        switch (expr.op) {
-            case LogicalOperator::And:
-                return processAndExpression(std::move(expr));
-            case LogicalOperator::Or:
-                return processOrExpression(std::move(expr));
+    Expression processLogicalExpression(LogicalExpression& expr, DagExpression node) {
+        const bool isShared = references.at(&*node) > 1;
+        if (isShared) {
+            auto pos = shared.find(&*node);
+            if (pos != shared.end()) {
+                chargeCopy(pos->second);
+                return pos->second;
+            }
         }
+
+        auto result = [&]() {
+            switch (expr.op) {
+                case LogicalOperator::And:
+                    return processAndExpression(std::move(expr), node);
+                case LogicalOperator::Or:
+                    return processOrExpression(std::move(expr), node);
+            }
+            __builtin_unreachable();
+        }();
+        if (isShared) {
+            shared.emplace(&*node, result);
+        }
+        return result;
     }
 
-    void flattenAndExprChildren(std::vector<Expression>& children) {
-        std::vector<Expression> newChildren{};
+    // Number of children a term of an $or adds to a conjunct: the children of an $and, or the term.
+    static size_t termSize(const Expression& term) {
+        if (auto expr = term.cast<LogicalExpression>()) {
+            assert(expr->op == LogicalOperator::And);
+            return expr->children.size();
+        }
+        return 1;
+    }
 
-        for (auto& child : children) {
-            if (child.is<LogicalExpression>()) {
-                auto expr = child.cast<LogicalExpression>();
-                assert(expr->op == LogicalOperator::And);
-                move(newChildren, expr->children);
+    // Append the children of the term to the conjunct, they are moved on the last use of the term.
+    static void appendTerm(std::vector<Expression>& conjunct, Expression& term, bool isLastUse) {
+        if (auto expr = term.cast<LogicalExpression>()) {
+            if (isLastUse) {
+                std::move(begin(expr->children), end(expr->children), std::back_inserter(conjunct));
             } else {
-                newChildren.emplace_back(std::move(child));
+                conjunct.insert(end(conjunct), begin(expr->children), end(expr->children));
             }
+        } else if (isLastUse) {
+            conjunct.emplace_back(std::move(term));
+        } else {
+            conjunct.emplace_back(term);
         }
-
-        children.swap(newChildren);
     }
 
-    void buildAndExpressions(std::vector<Expression> children,
-                             const std::vector<LogicalExpression>& ors,
-                             size_t orIndex,
-                             std::vector<Expression>& result) {
-        if (ors.size() == orIndex) {
-            flattenAndExprChildren(children);
+    // Build a conjunct for every combination of the terms of the $ors, the last $or changes first.
+    // Every conjunct is allocated once with its final size, and the leaves are moved into the last
+    // conjunct which uses them instead of being copied.
+    std::vector<Expression> buildAndExpressions(std::vector<Expression>& ands,
+                                                std::vector<LogicalExpression>& ors) {
+        std::vector<Expression> result{};
+        size_t numConjuncts = 1;
+        for (const auto& orExpr : ors) {
+            numConjuncts = saturatingMultiply(numConjuncts, orExpr.children.size());
+        }
+        if (numConjuncts == 0) {
+            return result;
+        }
+        result.reserve(numConjuncts);
+
+        // A term is used for the last time when the other $ors are at their last terms.
+        std::vector<size_t> choice(ors.size(), 0);
+        size_t numNotAtLastTerm = 0;
+        for (const auto& orExpr : ors) {
+            numNotAtLastTerm += orExpr.children.size() > 1 ? 1 : 0;
+        }
+
+        while (true) {
+            tracker.tick();
+
+            size_t size = ands.size();
+            for (size_t i = 0; i < ors.size(); ++i) {
+                size += termSize(ors[i].children[choice[i]]);
+            }
+
+            std::vector<Expression> children{};
+            children.reserve(size);
+            if (numNotAtLastTerm == 0) {
+                std::move(begin(ands), end(ands), std::back_inserter(children));
+            } else {
+                children.insert(end(children), begin(ands), end(ands));
+            }
+            for (size_t i = 0; i < ors.size(); ++i) {
+                const bool isAtLastTerm = choice[i] + 1 == ors[i].children.size();
+                const bool isLastUse = numNotAtLastTerm == (isAtLastTerm ? 0 : 1);
+                appendTerm(children, ors[i].children[choice[i]], isLastUse);
+            }
             result.push_back(
                 Expression::make<LogicalExpression>(LogicalOperator::And, std::move(children)));
-        } else {
-            auto& orExpr = ors[orIndex];
-            for (size_t childIndex = 0; childIndex < orExpr.children.size(); ++childIndex) {
-                if (childIndex == 0) {
-                    children.push_back(orExpr.children[childIndex]);
-                } else {
-                    children.back() = orExpr.children[childIndex];
+
+            size_t i = ors.size();
+            for (; i > 0; --i) {
+                const size_t numTerms = ors[i - 1].children.size();
+                if (++choice[i - 1] < numTerms) {
+                    numNotAtLastTerm -= choice[i - 1] + 1 == numTerms ? 1 : 0;
+                    break;
                 }
-                buildAndExpressions(children, ors, orIndex + 1, result);
+                choice[i - 1] = 0;
+                numNotAtLastTerm += numTerms > 1 ? 1 : 0;
+            }
+            if (i == 0) {
+                break;
             }
         }
+
+        return result;
     }
 
-    Expression processAndExpression(LogicalExpression&& expr) {
+    Expression processAndExpression(LogicalExpression&& expr, DagExpression node) {
         std::vector<Expression> ands{};
         std::vector<LogicalExpression> ors{};
 
-        for (auto&& child : expr.children) {
+        for (size_t i = 0; i < expr.children.size(); ++i) {
+            auto& child = expr.children[i];
             if (child.is<LogicalExpression>()) {
-                auto processed = processLogicalExpression(*child.cast<LogicalExpression>());
+                auto processed =
+                    processLogicalExpression(*child.cast<LogicalExpression>(), node->children[i]);
                 auto childExpr = processed.cast<LogicalExpression>();
 
                 switch (childExpr->op) {
@@ -156,18 +236,20 @@ struct DNFTransformer {
             return Expression::make<LogicalExpression>(LogicalOperator::And, std::move(ands));
         }
 
-        std::vector<Expression> children{};
-        buildAndExpressions(ands, ors, 0, children);
+        chargeConjuncts(ands, ors);
 
-        return Expression::make<LogicalExpression>(LogicalOperator::Or, std::move(children));
+        return Expression::make<LogicalExpression>(LogicalOperator::Or,
+                                                   buildAndExpressions(ands, ors));
     }
 
-    Expression processOrExpression(LogicalExpression&& expr) {
+    Expression processOrExpression(LogicalExpression&& expr, DagExpression node) {
         std::vector<Expression> children{};
 
-        for (auto&& child : expr.children) {
+        for (size_t i = 0; i < expr.children.size(); ++i) {
+            auto& child = expr.children[i];
             if (child.is<LogicalExpression>()) {
-                auto processed = processLogicalExpression(*child.cast<LogicalExpression>());
+                auto processed =
+                    processLogicalExpression(*child.cast<LogicalExpression>(), node->children[i]);
                 auto childExpr = processed.cast<LogicalExpression>();
                 switch (childExpr->op) {
                     case LogicalOperator::And:
@@ -185,18 +267,264 @@ struct DNFTransformer {
         return Expression::make<LogicalExpression>(LogicalOperator::Or, std::move(children));
     }
 
-    Expression operator()(const Expression&, ComparisonExpression& expr) {
-        return Expression::make<ComparisonExpression>(expr);
+    // Check that the expansion of the $and fits the budget before any conjunct is built.
+    void chargeConjuncts(const std::vector<Expression>& ands,
+                         const std::vector<LogicalExpression>& ors) {
+        size_t numConjuncts = 1;
+        for (const auto& orExpr : ors) {
+            numConjuncts = saturatingMultiply(numConjuncts, orExpr.children.size());
+        }
+
+        // Estimated size of a conjunct with its children vector and copies of the leaves.
+        const size_t conjunctBytes = sizeof(LogicalExpression) +
+            (ands.size() + ors.size()) * (sizeof(Expression) + sizeof(ComparisonExpression));
+        tracker.charge(numConjuncts, saturatingMultiply(numConjuncts, conjunctBytes));
     }
 
-    Expression operator()(const Expression&, InExpression& expr) {
-        return Expression::make<InExpression>(expr);
+    // A copy of the DNF of a shared subtree is charged like the conjuncts it copies.
+    void chargeCopy(const Expression& dnf) {
+        const auto& expr = *dnf.cast<LogicalExpression>();
+        const size_t numConjuncts = expr.op == LogicalOperator::Or ? expr.children.size() : 1;
+        tracker.charge(numConjuncts, numConjuncts * sizeof(LogicalExpression));
+    }
+
+    // A leaf root is already in DNF, the transformer owns the expression and moves it out.
+    Expression operator()(Expression& e, ComparisonExpression&) {
+        return std::move(e);
+    }
+
+    Expression operator()(Expression& e, InExpression&) {
+        return std::move(e);
     }
 
     Expression operator()(const Expression&, NotExpression& expr) {
         throw std::runtime_error("NotExpression is not expected");
     }
+
+    ExpansionBudgetTracker& tracker;
+    const DagExpression root;
+    // Number of references to every node of the DAG, the subtrees referred to more than once are
+    // shared.
+    const std::unordered_map<const DagNode*, size_t> references;
+    // DNF of the shared subtrees.
+    std::unordered_map<const DagNode*, Expression> shared{};
 };
+// Copy the subtree of the flat expression without negations, return the index of the next sibling.
+size_t copyWithoutNots(const FlatExpression& expr,
+                       size_t index,
+                       bool inNot,
+                       FlatExpression& result) {
+    const auto& node = expr.nodes[index];
+    switch (node.kind) {
+        case FlatNodeKind::And:
+            [[fallthrough]];
+        case FlatNodeKind::Or: {
+            const bool isAnd = (node.kind == FlatNodeKind::And) != inNot;
+            const size_t resultIndex = result.open(isAnd ? FlatNodeKind::And : FlatNodeKind::Or);
+            forEachChild(
+                expr, index, [&](size_t child) { copyWithoutNots(expr, child, inNot, result); });
+            result.close(resultIndex, node.arg);
+            break;
+        }
+        case FlatNodeKind::Not:
+            copyWithoutNots(expr, index + 1, !inNot, result);
+            break;
+        case FlatNodeKind::Comparison: {
+            const auto& leaf = expr.leaves[node.arg];
+            result.addComparison(inNot ? negate(leaf.comparisonOp) : leaf.comparisonOp,
+                                 leaf.path,
+                                 expr.values[leaf.valuesBegin]);
+            break;
+        }
+        case FlatNodeKind::In: {
+            const auto& leaf = expr.leaves[node.arg];
+            result.addIn(inNot ? negate(leaf.inOp) : leaf.inOp, leaf.path, expr.leafValues(leaf));
+            break;
+        }
+    }
+    return index + node.size;
+}
+
+// Conjunction of the subtrees of a flat expression rooted at the given nodes, or a single subtree
+// if isAnd is false.
+struct FlatTerm {
+    bool isAnd;
+    std::vector<size_t> subtrees;
+};
+
+// DNF of a logical node of a flat expression: a conjunction, represented by a single term, or a
+// disjunction of terms.
+struct FlatDNF {
+    LogicalOperator op;
+    std::vector<FlatTerm> terms;
+};
+
+/**
+ * DNF transformation of a flat expression. It follows DNFTransformer: the result has the same shape
+ * and order of children. Leaves are referred to by their node indexes until the result is written,
+ * so that they are copied once.
+ */
+struct FlatDNFTransformer {
+    FlatDNFTransformer(const FlatExpression& expr, ExpansionBudgetTracker& tracker)
+        : expr(expr), tracker(tracker) {}
+
+    bool isLogical(size_t index) const {
+        const auto kind = expr.nodes[index].kind;
+        return kind == FlatNodeKind::And || kind == FlatNodeKind::Or;
+    }
+
+    FlatDNF processLogical(size_t index) {
+        if (expr.nodes[index].kind == FlatNodeKind::And) {
+            return processAnd(index);
+        }
+        return processOr(index);
+    }
+
+    FlatDNF processAnd(size_t index) {
+        std::vector<size_t> ands{};
+        std::vector<std::vector<FlatTerm>> ors{};
+
+        forEachChild(expr, index, [&](size_t child) {
+            if (!isLogical(child)) {
+                ands.push_back(child);
+                return;
+            }
+
+            auto processed = processLogical(child);
+            switch (processed.op) {
+                case LogicalOperator::And: {
+                    const auto& subtrees = processed.terms.front().subtrees;
+                    ands.insert(ands.end(), subtrees.begin(), subtrees.end());
+                    break;
+                }
+                case LogicalOperator::Or:
+                    ors.push_back(std::move(processed.terms));
+                    break;
+            }
+        });
+
+        if (ors.empty()) {
+            return {LogicalOperator::And, {{true, std::move(ands)}}};
+        }
+
+        std::vector<FlatTerm> conjuncts{};
+        for (const auto& orTerms : ors) {
+            if (orTerms.empty()) {
+                return {LogicalOperator::Or, std::move(conjuncts)};
+            }
+        }
+
+        chargeConjuncts(ands, ors);
+
+        // Enumerate the combinations of the terms of the $ors, the last $or changes first.
+        std::vector<size_t> choice(ors.size(), 0);
+        while (true) {
+            tracker.tick();
+
+            auto& conjunct = conjuncts.emplace_back(FlatTerm{true, ands});
+            for (size_t i = 0; i < ors.size(); ++i) {
+                const auto& subtrees = ors[i][choice[i]].subtrees;
+                conjunct.subtrees.insert(conjunct.subtrees.end(), subtrees.begin(), subtrees.end());
+            }
+
+            size_t i = ors.size();
+            while (i > 0 && ++choice[i - 1] == ors[i - 1].size()) {
+                choice[i - 1] = 0;
+                --i;
+            }
+            if (i == 0) {
+                break;
+            }
+        }
+
+        return {LogicalOperator::Or, std::move(conjuncts)};
+    }
+
+    FlatDNF processOr(size_t index) {
+        std::vector<FlatTerm> terms{};
+
+        forEachChild(expr, index, [&](size_t child) {
+            if (!isLogical(child)) {
+                terms.push_back({false, {child}});
+                return;
+            }
+
+            auto processed = processLogical(child);
+            std::move(processed.terms.begin(), processed.terms.end(), std::back_inserter(terms));
+        });
+
+        return {LogicalOperator::Or, std::move(terms)};
+    }
+
+    // Check that the expansion of the $and fits the budget before any conjunct is built, as
+    // DNFTransformer does.
+    void chargeConjuncts(const std::vector<size_t>& ands,
+                         const std::vector<std::vector<FlatTerm>>& ors) {
+        size_t numConjuncts = 1;
+        for (const auto& orTerms : ors) {
+            numConjuncts = saturatingMultiply(numConjuncts, orTerms.size());
+        }
+
+        // Estimated size of a conjunct with at least one subtree of every $or.
+        const size_t conjunctBytes = sizeof(FlatTerm) + (ands.size() + ors.size()) * sizeof(size_t);
+        tracker.charge(numConjuncts, saturatingMultiply(numConjuncts, conjunctBytes));
+    }
+
+    void addConjunction(const std::vector<size_t>& subtrees, FlatExpression& result) const {
+        const size_t index = result.open(FlatNodeKind::And);
+        for (auto subtree : subtrees) {
+            result.addSubtree(expr, subtree);
+        }
+        result.close(index, static_cast<uint32_t>(subtrees.size()));
+    }
+
+    const FlatExpression& expr;
+    ExpansionBudgetTracker& tracker;
+};
+
+void checkNotEmpty(const FlatExpression& expr) {
+    if (expr.nodes.empty()) {
+        throw std::runtime_error("FlatExpression is empty");
+    }
+}
+
+// DNF of the flat expression, the expansion of every $and is charged to the tracker.
+FlatExpression expandToDNF(const FlatExpression& expr, ExpansionBudgetTracker& tracker) {
+    checkNotEmpty(expr);
+
+    FlatExpression result{};
+    switch (expr.nodes.front().kind) {
+        case FlatNodeKind::And:
+            [[fallthrough]];
+        case FlatNodeKind::Or:
+            break;
+        case FlatNodeKind::Not:
+            throw std::runtime_error("NotExpression is not expected");
+        case FlatNodeKind::Comparison:
+            [[fallthrough]];
+        case FlatNodeKind::In:
+            result.addSubtree(expr, 0);
+            return result;
+    }
+
+    FlatDNFTransformer transformer{expr, tracker};
+    auto dnf = transformer.processLogical(0);
+    if (dnf.op == LogicalOperator::And) {
+        transformer.addConjunction(dnf.terms.front().subtrees, result);
+        return result;
+    }
+
+    const size_t index = result.open(FlatNodeKind::Or);
+    for (const auto& term : dnf.terms) {
+        if (term.isAnd) {
+            transformer.addConjunction(term.subtrees, result);
+        } else {
+            result.addSubtree(expr, term.subtrees.front());
+        }
+    }
+    result.close(index, static_cast<uint32_t>(dnf.terms.size()));
+    return result;
+}
 }  // namespace
 
 Expression removeNotExpressions(Expression root) {
@@ -204,7 +532,47 @@ Expression removeNotExpressions(Expression root) {
 }
 
 Expression transformToDNF(Expression expression) {
-    return expression.visit(DNFTransformer{});
+    ExpansionBudgetTracker tracker{ExpansionBudget{}};
+    ExpressionPool pool{};
+    return expression.visit(DNFTransformer{tracker, pool.intern(expression)});
+}
+
+DNFResult tryTransformToDNF(Expression expression, const ExpansionBudget& budget) {
+    // The transformer consumes the expression, keep a copy to fall back to.
+    Expression original = expression;
+    try {
+        ExpansionBudgetTracker tracker{budget};
+        ExpressionPool pool{};
+        return {ExpansionStatus::Ok,
+                expression.visit(DNFTransformer{tracker, pool.intern(expression)})};
+    } catch (const ExpansionBudgetExceeded& ex) {
+        return {ex.status, std::move(original)};
+    }
+}
+
+FlatExpression removeNotExpressions(const FlatExpression& expr) {
+    checkNotEmpty(expr);
+
+    FlatExpression result{};
+    result.nodes.reserve(expr.nodes.size());
+    result.leaves.reserve(expr.leaves.size());
+    result.values.reserve(expr.values.size());
+    copyWithoutNots(expr, 0, false, result);
+    return result;
+}
+
+FlatExpression transformToDNF(const FlatExpression& expr) {
+    ExpansionBudgetTracker tracker{ExpansionBudget{}};
+    return expandToDNF(expr, tracker);
+}
+
+FlatDNFResult tryTransformToDNF(const FlatExpression& expr, const ExpansionBudget& budget) {
+    try {
+        ExpansionBudgetTracker tracker{budget};
+        return {ExpansionStatus::Ok, expandToDNF(expr, tracker)};
+    } catch (const ExpansionBudgetExceeded& ex) {
+        return {ex.status, expr};
+    }
 }
 
 }  // namespace predicate_optimizer
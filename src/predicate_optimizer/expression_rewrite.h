@@ -1,12 +1,47 @@
 #pragma once
 
+#include "expansion_budget.h"
 #include "expression.h"
+#include "flat_expression.h"
 
 namespace predicate_optimizer {
+/* Operators of the negated expressions: $and and $or are swapped by De Morgan's laws, comparisons
+ * and $in are replaced by their complements.*/
+LogicalOperator negate(LogicalOperator op);
+ComparisonOperator negate(ComparisonOperator op);
+InOperator negate(InOperator op);
+
 /* Remove negate operators from the expression. */
 Expression removeNotExpressions(Expression root);
 
 /* Transform the expression to disjunctive normal form. This function does not accept boolean
  * expressions containing negations.*/
 Expression transformToDNF(Expression expression);
+
+struct DNFResult {
+    ExpansionStatus status;
+    // The expression in DNF, or the original expression if the budget was exhausted.
+    Expression expression;
+};
+
+/* Same as transformToDNF, but stops the expansion cleanly when the budget is exhausted and returns
+ * the original expression with the status of the exceeded limit. The minterm limit applies to the
+ * number of conjuncts of every expanded $and.*/
+DNFResult tryTransformToDNF(Expression expression, const ExpansionBudget& budget);
+
+/* Same as removeNotExpressions and transformToDNF for the flat representation. The results are
+ * equal to the flat representations of the results of the tree versions. Both throw on an empty
+ * flat expression.*/
+FlatExpression removeNotExpressions(const FlatExpression& expr);
+FlatExpression transformToDNF(const FlatExpression& expr);
+
+struct FlatDNFResult {
+    ExpansionStatus status;
+    // The flat expression in DNF, or the original expression if the budget was exhausted.
+    FlatExpression expression;
+};
+
+/* Same as tryTransformToDNF for the flat representation, the budget is charged as by the tree
+ * version.*/
+FlatDNFResult tryTransformToDNF(const FlatExpression& expr, const ExpansionBudget& budget);
 }  // namespace predicate_optimizer
@@ -212,4 +212,73 @@ TEST_CASE("Or Push Up", "") {
         REQUIRE(expected == processed);
     }
 }
+
+TEST_CASE("Or Push Up with conjunctions in ors", "") {
+    auto expr = makeAnd({
+        makeEq("a", "1"),
+        makeOr({makeAnd({makeEq("b", "1"), makeEq("c", "1")}), makeEq("b", "2")}),
+        makeOr({makeEq("d", "1")}),
+        makeOr({makeEq("e", "1"), makeAnd({makeEq("e", "2"), makeEq("f", "2")})}),
+    });
+
+    auto expected = makeOr({
+        makeAnd({makeEq("a", "1"), makeEq("b", "1"), makeEq("c", "1"), makeEq("d", "1"),
+                 makeEq("e", "1")}),
+        makeAnd({makeEq("a", "1"), makeEq("b", "1"), makeEq("c", "1"), makeEq("d", "1"),
+                 makeEq("e", "2"), makeEq("f", "2")}),
+        makeAnd({makeEq("a", "1"), makeEq("b", "2"), makeEq("d", "1"), makeEq("e", "1")}),
+        makeAnd({makeEq("a", "1"), makeEq("b", "2"), makeEq("d", "1"), makeEq("e", "2"),
+                 makeEq("f", "2")}),
+    });
+
+    REQUIRE(expected == transformToDNF(std::move(expr)));
+    REQUIRE(makeIn("x", {"1"}) == transformToDNF(makeIn("x", {"1"})));
+    REQUIRE(makeOr({}) == transformToDNF(makeAnd({makeEq("a", "1"), makeOr({})})));
+}
+
+TEST_CASE("Or Push Up with shared subtrees", "") {
+    auto makeSubtree = []() {
+        return makeAnd({makeEq("a", "1"), makeOr({makeEq("b", "1"), makeEq("b", "2")})});
+    };
+    auto expr = makeAnd({makeOr({makeSubtree(), makeEq("d", "1")}), makeSubtree()});
+
+    auto expected = makeOr({
+        makeAnd({makeEq("a", "1"), makeEq("b", "1"), makeEq("a", "1"), makeEq("b", "1")}),
+        makeAnd({makeEq("a", "1"), makeEq("b", "1"), makeEq("a", "1"), makeEq("b", "2")}),
+        makeAnd({makeEq("a", "1"), makeEq("b", "2"), makeEq("a", "1"), makeEq("b", "1")}),
+        makeAnd({makeEq("a", "1"), makeEq("b", "2"), makeEq("a", "1"), makeEq("b", "2")}),
+        makeAnd({makeEq("d", "1"), makeEq("a", "1"), makeEq("b", "1")}),
+        makeAnd({makeEq("d", "1"), makeEq("a", "1"), makeEq("b", "2")}),
+    });
+
+    REQUIRE(expected == transformToDNF(expr));
+    REQUIRE(tryTransformToDNF(expr, {.maxMinterms = 5}).status ==
+            ExpansionStatus::MintermLimitExceeded);
+}
+
+TEST_CASE("Or Push Up budget", "") {
+    auto expr = makeAnd({
+        makeOr({makeEq("a", "1"), makeEq("a", "2"), makeEq("a", "3")}),
+        makeOr({makeEq("b", "1"), makeEq("b", "2"), makeEq("b", "3")}),
+        makeEq("c", "1"),
+    });
+
+    SECTION("minterm limit") {
+        auto result = tryTransformToDNF(expr, {.maxMinterms = 8});
+        REQUIRE(result.status == ExpansionStatus::MintermLimitExceeded);
+        REQUIRE(result.expression == expr);
+    }
+
+    SECTION("memory limit") {
+        auto result = tryTransformToDNF(expr, {.maxBytes = 64});
+        REQUIRE(result.status == ExpansionStatus::MemoryLimitExceeded);
+        REQUIRE(result.expression == expr);
+    }
+
+    SECTION("within the limits") {
+        auto result = tryTransformToDNF(expr, {.maxMinterms = 9});
+        REQUIRE(result.status == ExpansionStatus::Ok);
+        REQUIRE(result.expression == transformToDNF(expr));
+    }
+}
 }  // namespace predicate_optimizer
@@ -0,0 +1,20 @@
+#include "Catch2/catch_amalgamated.hpp"
+#include "predicate_optimizer/expression.h"
+#include "predicate_optimizer/expression_utils.h"
+
+namespace predicate_optimizer {
+TEST_CASE("$in values", "") {
+    SECTION("Sorted and deduplicated") {
+        auto expr = makeIn("a", {"2", "1", "2", "10"});
+        REQUIRE(expr.cast<InExpression>()->values == std::vector<Value>{"1", "10", "2"});
+    }
+
+    SECTION("Equal in any order") {
+        auto lhs = makeNotIn("a", {"1", "2", "3"});
+        auto rhs = makeNotIn("a", {"3", "1", "2", "1"});
+        REQUIRE(lhs == rhs);
+        REQUIRE(std::hash<Expression>{}(lhs) == std::hash<Expression>{}(rhs));
+        REQUIRE(lhs != makeNotIn("a", {"1", "2"}));
+    }
+}
+}  // namespace predicate_optimizer
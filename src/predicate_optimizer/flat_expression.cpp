@@ -0,0 +1,143 @@
+#include "predicate_optimizer/flat_expression.h"
+
+namespace predicate_optimizer {
+namespace {
+struct FlattenVisitor {
+    void operator()(const Expression&, const LogicalExpression& expr) {
+        const size_t index = result.open(expr.op == LogicalOperator::And ? FlatNodeKind::And
+                                                                          : FlatNodeKind::Or);
+        for (const auto& child : expr.children) {
+            child.visit(*this);
+        }
+        result.close(index, static_cast<uint32_t>(expr.children.size()));
+    }
+
+    void operator()(const Expression&, const ComparisonExpression& expr) {
+        result.addComparison(expr.op, expr.path, expr.value);
+    }
+
+    void operator()(const Expression&, const InExpression& expr) {
+        result.addIn(expr.op, expr.path, expr.values);
+    }
+
+    void operator()(const Expression&, const NotExpression& expr) {
+        const size_t index = result.open(FlatNodeKind::Not);
+        expr.child.visit(*this);
+        result.close(index, 1);
+    }
+
+    FlatExpression& result;
+};
+
+// Build the Expression of the subtree and return the index of the next sibling.
+size_t buildExpression(const FlatExpression& flat, size_t index, Expression& result) {
+    const auto& node = flat.nodes[index];
+    switch (node.kind) {
+        case FlatNodeKind::And:
+            [[fallthrough]];
+        case FlatNodeKind::Or: {
+            std::vector<Expression> children(node.arg);
+            size_t child = index + 1;
+            for (auto& childExpr : children) {
+                child = buildExpression(flat, child, childExpr);
+            }
+            const auto op =
+                node.kind == FlatNodeKind::And ? LogicalOperator::And : LogicalOperator::Or;
+            result = Expression::make<LogicalExpression>(op, std::move(children));
+            break;
+        }
+        case FlatNodeKind::Not: {
+            Expression child{};
+            buildExpression(flat, index + 1, child);
+            result = Expression::make<NotExpression>(std::move(child));
+            break;
+        }
+        case FlatNodeKind::Comparison:
+            [[fallthrough]];
+        case FlatNodeKind::In:
+            result = flat.leafExpression(index);
+            break;
+    }
+    return index + node.size;
+}
+}  // namespace
+
+FlatExpression::FlatExpression(const Expression& expr) {
+    expr.visit(FlattenVisitor{*this});
+}
+
+Expression FlatExpression::toExpression() const {
+    Expression result{};
+    buildExpression(*this, 0, result);
+    return result;
+}
+
+Expression FlatExpression::leafExpression(size_t nodeIndex) const {
+    const auto& node = nodes[nodeIndex];
+    const auto& leaf = leaves[node.arg];
+    if (node.kind == FlatNodeKind::Comparison) {
+        return Expression::make<ComparisonExpression>(
+            leaf.comparisonOp, leaf.path, values[leaf.valuesBegin]);
+    }
+
+    auto leafValuesRange = leafValues(leaf);
+    return Expression::make<InExpression>(
+        leaf.inOp, leaf.path, std::vector<Value>(leafValuesRange.begin(), leafValuesRange.end()));
+}
+
+size_t FlatExpression::open(FlatNodeKind kind) {
+    nodes.push_back({kind, 1, 0});
+    return nodes.size() - 1;
+}
+
+void FlatExpression::close(size_t nodeIndex, uint32_t numChildren) {
+    auto& node = nodes[nodeIndex];
+    node.size = static_cast<uint32_t>(nodes.size() - nodeIndex);
+    node.arg = numChildren;
+}
+
+void FlatExpression::addComparison(ComparisonOperator op, Path path, Value value) {
+    const auto valuesBegin = static_cast<uint32_t>(values.size());
+    values.push_back(value);
+    nodes.push_back({FlatNodeKind::Comparison, 1, static_cast<uint32_t>(leaves.size())});
+    leaves.push_back({op, InOperator::In, path, valuesBegin, valuesBegin + 1});
+}
+
+void FlatExpression::addIn(InOperator op, Path path, std::span<const Value> inValues) {
+    const auto valuesBegin = static_cast<uint32_t>(values.size());
+    values.insert(values.end(), inValues.begin(), inValues.end());
+    nodes.push_back({FlatNodeKind::In, 1, static_cast<uint32_t>(leaves.size())});
+    leaves.push_back({ComparisonOperator::EQ,
+                      op,
+                      path,
+                      valuesBegin,
+                      static_cast<uint32_t>(values.size())});
+}
+
+void FlatExpression::addSubtree(const FlatExpression& other, size_t nodeIndex) {
+    const size_t end = nodeIndex + other.nodes[nodeIndex].size;
+    for (size_t i = nodeIndex; i < end; ++i) {
+        const auto& node = other.nodes[i];
+        switch (node.kind) {
+            case FlatNodeKind::And:
+                [[fallthrough]];
+            case FlatNodeKind::Or:
+                [[fallthrough]];
+            case FlatNodeKind::Not:
+                // Sizes and numbers of children of the copied nodes do not change.
+                nodes.push_back(node);
+                break;
+            case FlatNodeKind::Comparison: {
+                const auto& leaf = other.leaves[node.arg];
+                addComparison(leaf.comparisonOp, leaf.path, other.values[leaf.valuesBegin]);
+                break;
+            }
+            case FlatNodeKind::In: {
+                const auto& leaf = other.leaves[node.arg];
+                addIn(leaf.inOp, leaf.path, other.leafValues(leaf));
+                break;
+            }
+        }
+    }
+}
+}  // namespace predicate_optimizer
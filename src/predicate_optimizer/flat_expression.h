@@ -0,0 +1,73 @@
+#pragma once
+
+#include "predicate_optimizer/expression.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace predicate_optimizer {
+enum class FlatNodeKind : uint8_t { And, Or, Not, Comparison, In };
+
+struct FlatNode {
+    FlatNodeKind kind;
+    // Number of nodes of the subtree including this one, the next sibling is at index + size.
+    uint32_t size;
+    // Number of children of a logical node, the index of the leaf of a comparison or $in node.
+    uint32_t arg;
+};
+
+struct FlatLeaf {
+    // Operator of a comparison leaf.
+    ComparisonOperator comparisonOp{ComparisonOperator::EQ};
+    // Operator of a $in leaf.
+    InOperator inOp{InOperator::In};
+    Path path;
+    // Range of the leaf in FlatExpression::values, a comparison has exactly one value.
+    uint32_t valuesBegin;
+    uint32_t valuesEnd;
+};
+
+/**
+ * Immutable linearized Expression: the nodes are stored in pre-order in one array, the children of
+ * a node follow it, and the paths and values of the leaves are kept in side tables. Walking the
+ * expression is a sequential scan of the arrays instead of chasing a pointer per node and per
+ * children vector.
+ */
+struct FlatExpression {
+    FlatExpression() {}
+    explicit FlatExpression(const Expression& expr);
+
+    Expression toExpression() const;
+
+    // Build the Expression of the comparison or $in node.
+    Expression leafExpression(size_t nodeIndex) const;
+
+    std::span<const Value> leafValues(const FlatLeaf& leaf) const {
+        return {values.data() + leaf.valuesBegin, values.data() + leaf.valuesEnd};
+    }
+
+    // Builder interface: open() a logical or $not node, add its children and close() it.
+    size_t open(FlatNodeKind kind);
+    void close(size_t nodeIndex, uint32_t numChildren);
+    void addComparison(ComparisonOperator op, Path path, Value value);
+    void addIn(InOperator op, Path path, std::span<const Value> values);
+    // Append a copy of the subtree of the other expression rooted at the given node.
+    void addSubtree(const FlatExpression& other, size_t nodeIndex);
+
+    std::vector<FlatNode> nodes;
+    std::vector<FlatLeaf> leaves;
+    std::vector<Value> values;
+};
+
+// Call the function with the index of every child of the logical or $not node in order.
+template <typename Function>
+void forEachChild(const FlatExpression& expr, size_t nodeIndex, Function&& function) {
+    const auto& node = expr.nodes[nodeIndex];
+    const uint32_t numChildren = node.kind == FlatNodeKind::Not ? 1 : node.arg;
+    size_t child = nodeIndex + 1;
+    for (uint32_t i = 0; i < numChildren; ++i) {
+        function(child);
+        child += expr.nodes[child].size;
+    }
+}
+}  // namespace predicate_optimizer
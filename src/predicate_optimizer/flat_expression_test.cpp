@@ -0,0 +1,123 @@
+#include "Catch2/catch_amalgamated.hpp"
+#include "expression_dnf.h"
+#include "expression_rewrite.h"
+#include "expression_utils.h"
+#include "flat_expression.h"
+
+#include <random>
+
+namespace predicate_optimizer {
+namespace {
+// Random expression of the given depth over a few paths and values.
+Expression makeRandomExpression(std::mt19937& gen, int depth) {
+    const auto path = std::string(1, static_cast<char>('a' + gen() % 3));
+    const auto value = std::to_string(gen() % 3);
+    switch (depth == 0 ? 2 + gen() % 3 : gen() % 6) {
+        case 0:
+            [[fallthrough]];
+        case 1: {
+            std::vector<Expression> children{};
+            const size_t numChildren = 1 + gen() % 3;
+            for (size_t i = 0; i < numChildren; ++i) {
+                children.emplace_back(makeRandomExpression(gen, depth - 1));
+            }
+            return gen() % 2 == 0 ? makeAnd(std::move(children)) : makeOr(std::move(children));
+        }
+        case 2:
+            return gen() % 2 == 0 ? makeLt(path, value) : makeEq(path, value);
+        case 3:
+            return gen() % 2 == 0 ? makeIn(path, {value, "x"}) : makeNotIn(path, {value});
+        case 4:
+            return makeGe(path, value);
+        default:
+            return makeNot(makeRandomExpression(gen, depth - 1));
+    }
+}
+}  // namespace
+
+TEST_CASE("Flat expression", "") {
+    SECTION("Round trip") {
+        auto expr = makeAnd({makeOr({makeEq("a", "1"), makeNot(makeGt("b", "2"))}),
+                             makeIn("c", {"3", "4"}),
+                             makeNotIn("d", {})});
+        FlatExpression flat{expr};
+
+        REQUIRE(flat.nodes.size() == 7);
+        REQUIRE(flat.nodes[0].size == 7);
+        REQUIRE(flat.nodes[0].arg == 3);
+        REQUIRE(flat.nodes[1].size == 4);
+        REQUIRE(flat.leaves.size() == 4);
+        REQUIRE(flat.values.size() == 4);
+        REQUIRE(expr == flat.toExpression());
+    }
+
+    SECTION("Not removal") {
+        auto expr = makeNot(makeAnd({makeOr({makeEq("a", "1"), makeNot(makeLt("b", "2"))}),
+                                     makeIn("c", {"3", "4"})}));
+        auto expected = removeNotExpressions(expr);
+
+        auto processed = removeNotExpressions(FlatExpression{expr});
+        REQUIRE(expected == processed.toExpression());
+    }
+
+    SECTION("DNF") {
+        auto expr = makeAnd({
+            makeAnd({makeEq("a", "1"), makeEq("b", "1")}),
+            makeAnd({makeEq("c", "1"), makeOr({makeEq("d", "2"), makeEq("d", "3")})}),
+            makeOr({makeEq("e", "1"), makeAnd({makeEq("e", "2"), makeEq("f", "2")})}),
+        });
+        auto expected = transformToDNF(expr);
+
+        auto processed = transformToDNF(FlatExpression{expr});
+        REQUIRE(expected == processed.toExpression());
+    }
+
+    SECTION("DNF budget") {
+        auto expr = makeAnd({
+            makeOr({makeEq("a", "1"), makeEq("a", "2"), makeEq("a", "3")}),
+            makeOr({makeEq("b", "1"), makeEq("b", "2"), makeEq("b", "3")}),
+            makeEq("c", "1"),
+        });
+        FlatExpression flat{expr};
+
+        auto exceeded = tryTransformToDNF(flat, {.maxMinterms = 8});
+        REQUIRE(exceeded.status == ExpansionStatus::MintermLimitExceeded);
+        REQUIRE(exceeded.expression.toExpression() == expr);
+        REQUIRE(tryTransformToDNF(flat, {.maxBytes = 64}).status ==
+                ExpansionStatus::MemoryLimitExceeded);
+
+        auto result = tryTransformToDNF(flat, {.maxMinterms = 9});
+        REQUIRE(result.status == ExpansionStatus::Ok);
+        REQUIRE(result.expression.toExpression() == transformToDNF(expr));
+    }
+
+    SECTION("Empty expression") {
+        FlatExpression empty{};
+        REQUIRE_THROWS_AS(removeNotExpressions(empty), std::runtime_error);
+        REQUIRE_THROWS_AS(transformToDNF(empty), std::runtime_error);
+        REQUIRE_THROWS_AS(tryTransformToDNF(empty, {}), std::runtime_error);
+        REQUIRE_THROWS_AS(transformToNormalForm(empty), std::runtime_error);
+    }
+
+    SECTION("Same results as the tree rewrites") {
+        std::mt19937 gen{2024};
+        for (int i = 0; i < 200; ++i) {
+            auto expr = makeRandomExpression(gen, 4);
+            FlatExpression flat{expr};
+            REQUIRE(expr == flat.toExpression());
+
+            auto withoutNots = removeNotExpressions(expr);
+            auto flatWithoutNots = removeNotExpressions(flat);
+            REQUIRE(withoutNots == flatWithoutNots.toExpression());
+
+            auto dnf = transformToDNF(withoutNots);
+            REQUIRE(dnf == transformToDNF(flatWithoutNots).toExpression());
+
+            auto [maxterm, expressions] = transformToNormalForm(expr);
+            auto [flatMaxterm, flatExpressions] = transformToNormalForm(flat);
+            REQUIRE(maxterm == flatMaxterm);
+            REQUIRE(expressions == flatExpressions);
+        }
+    }
+}
+}  // namespace predicate_optimizer
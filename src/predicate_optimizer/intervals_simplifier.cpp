@@ -1,6 +1,12 @@
 #include "predicate_optimizer/intervals_simplifier.h"
 
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <span>
 #include <sstream>
+#include <stdexcept>
+#include <unordered_map>
 
 namespace predicate_optimizer {
 namespace {
@@ -8,9 +14,13 @@ struct IntervalBound {
     bool isInclusive{false};
     std::optional<Value> value{};
     std::optional<size_t> bitIndex;
+    // Value of the bit of the predicate which defines the bound: set for the lower bounds and the
+    // points, cleared for the upper bounds of negated GE and GT.
+    bool bitValue{true};
 };
 
-// if lhs or rhs is empty, infinitySign argument defines whethere is plus or minus infinity.
+// if lhs or rhs is empty, infinitySign argument defines whethere is plus or minus infinity. Values
+// are compared by their parsed types, see TypedValue.
 int compare(const std::optional<Value>& lhs, const std::optional<Value>& rhs, int infinitySign) {
     if (!lhs && !rhs) {
         return 0;
@@ -24,11 +34,104 @@ int compare(const std::optional<Value>& lhs, const std::optional<Value>& rhs, in
         return -infinitySign;
     }
 
-    if (*lhs == *rhs) {
-        return 0;
+    const auto cmp = lhs->typed() <=> rhs->typed();
+    return cmp < 0 ? -1 : cmp > 0 ? 1 : 0;
+}
+
+// Return true if the sorted ranges share a value, by a merge.
+template <typename Lhs, typename Rhs, typename Less>
+bool intersects(const Lhs& lhs, const Rhs& rhs, Less less) {
+    auto lhsIt = begin(lhs);
+    auto rhsIt = begin(rhs);
+    while (lhsIt != end(lhs) && rhsIt != end(rhs)) {
+        if (less(*lhsIt, *rhsIt)) {
+            ++lhsIt;
+        } else if (less(*rhsIt, *lhsIt)) {
+            ++rhsIt;
+        } else {
+            return true;
+        }
     }
+    return false;
+}
+
+// Remove the values of the sorted range from the sorted vector, by a merge.
+template <typename T, typename Range, typename Less>
+void subtract(std::vector<T>& values, const Range& other, Less less) {
+    std::vector<T> result{};
+    result.reserve(values.size());
+    std::set_difference(begin(values),
+                        end(values),
+                        begin(other),
+                        end(other),
+                        std::back_inserter(result),
+                        less);
+    values = std::move(result);
+}
+
+// Intersect the sorted vector with the sorted range, by a merge.
+template <typename T, typename Range, typename Less>
+void intersect(std::vector<T>& values, const Range& other, Less less) {
+    std::vector<T> result{};
+    result.reserve(values.size());
+    std::set_intersection(begin(values),
+                          end(values),
+                          begin(other),
+                          end(other),
+                          std::back_inserter(result),
+                          less);
+    values = std::move(result);
+}
+
+// Indexes of the $in to keep among the $in of the same path, the intersection of their values is
+// the intersection of the values of all of them: a $in is dropped if the values of a smaller kept
+// one are a subset of its values. getValues(k) returns the sorted values of the k-th $in.
+template <typename GetValues, typename Less>
+std::vector<size_t> selectIns(size_t numIns, GetValues&& getValues, Less less) {
+    std::vector<size_t> order(numIns);
+    for (size_t k = 0; k < numIns; ++k) {
+        order[k] = k;
+    }
+    std::stable_sort(begin(order), end(order), [&](size_t lhs, size_t rhs) {
+        return getValues(lhs).size() < getValues(rhs).size();
+    });
+
+    std::vector<size_t> kept{};
+    for (auto k : order) {
+        const auto& values = getValues(k);
+        const bool isImplied = std::any_of(begin(kept), end(kept), [&](size_t other) {
+            const auto& otherValues = getValues(other);
+            return std::includes(
+                begin(values), end(values), begin(otherValues), end(otherValues), less);
+        });
+        if (!isImplied) {
+            kept.push_back(k);
+        }
+    }
+    return kept;
+}
 
-    return *lhs > *rhs ? 1 : -1;
+// Values of a $in or of a NEQ, sorted by their parsed types and deduplicated.
+using PointSet = std::vector<const TypedValue*>;
+
+bool lessTyped(const TypedValue* lhs, const TypedValue* rhs) {
+    return *lhs < *rhs;
+}
+
+PointSet makePointSet(const std::vector<Value>& values) {
+    PointSet result{};
+    result.reserve(values.size());
+    for (const auto& value : values) {
+        result.push_back(&value.typed());
+    }
+    std::sort(begin(result), end(result), lessTyped);
+    result.erase(std::unique(begin(result),
+                             end(result),
+                             [](const TypedValue* lhs, const TypedValue* rhs) {
+                                 return *lhs == *rhs;
+                             }),
+                 end(result));
+    return result;
 }
 
 struct Interval {
@@ -58,9 +161,8 @@ struct Interval {
             return false;
         }
 
-        return (*left.value > *right.value) ||
-            (*left.value == *right.value &&
-             (left.isInclusive == false || right.isInclusive == false));
+        const auto cmp = left.value->typed() <=> right.value->typed();
+        return cmp > 0 || (cmp == 0 && (left.isInclusive == false || right.isInclusive == false));
     }
 
     bool isPoint() const {
@@ -68,15 +170,32 @@ struct Interval {
             return false;
         }
 
-        return *left.value == *right.value && left.isInclusive && right.isInclusive;
+        return left.value->typed() == right.value->typed() && left.isInclusive &&
+            right.isInclusive;
+    }
+
+    bool contains(const TypedValue& value) const {
+        if (left.value) {
+            const auto cmp = value <=> left.value->typed();
+            if (cmp < 0 || (cmp == 0 && !left.isInclusive)) {
+                return false;
+            }
+        }
+        if (right.value) {
+            const auto cmp = value <=> right.value->typed();
+            if (cmp > 0 || (cmp == 0 && !right.isInclusive)) {
+                return false;
+            }
+        }
+        return true;
     }
 };
 
 std::ostream& operator<<(std::ostream& os, const Interval& interval) {
     os << (interval.left.isInclusive ? '[' : '(');
-    os << (interval.left.value ? *interval.left.value : "---");
+    os << (interval.left.value ? interval.left.value->str() : "---");
     os << ", ";
-    os << (interval.right.value ? *interval.right.value : "+++");
+    os << (interval.right.value ? interval.right.value->str() : "+++");
     os << (interval.right.isInclusive ? ']' : ')');
     return os;
 }
@@ -98,14 +217,14 @@ Interval makeInterval(const ComparisonExpression& cmpExpr, size_t bitIndex, bool
                 return Interval{{true, cmpExpr.value, bitIndex}, {}};
             } else {
                 // LT
-                return Interval{{}, {false, cmpExpr.value, bitIndex}};
+                return Interval{{}, {false, cmpExpr.value, bitIndex, false}};
             }
         case ComparisonOperator::GT:
             if (bitValue) {
                 return Interval{{false, cmpExpr.value, bitIndex}, {}};
             } else {
                 // LE
-                return Interval{{}, {true, cmpExpr.value, bitIndex}};
+                return Interval{{}, {true, cmpExpr.value, bitIndex, false}};
             }
         case ComparisonOperator::LE:
             [[fallthrough]];
@@ -113,21 +232,33 @@ Interval makeInterval(const ComparisonExpression& cmpExpr, size_t bitIndex, bool
             [[fallthrough]];
         case ComparisonOperator::NE:
             throw std::runtime_error("Unexpected negative comparison operator");
-    };
+    }
+    __builtin_unreachable();
 }
 
+struct PointSetLiteral {
+    PointSet values;
+    size_t bitIndex;
+};
+
 struct IntervalData {
     Interval interval;
-    std::vector<std::pair<Value, size_t>> neqs{};
+    // Set $in literals.
+    std::vector<PointSetLiteral> ins{};
+    // Excluded values: cleared NEQ and $in literals, in the order of their bits.
+    std::vector<PointSetLiteral> exclusions{};
 };
 
 struct Visitor {
+    explicit Visitor(size_t numPredicates) : minterm(Minterm::withSize(numPredicates)) {}
+
     bool operator()(const Expression& expr,
                     const ComparisonExpression& cmpExpr,
                     size_t bitIndex,
                     bool bitValue) {
         if (cmpExpr.op == ComparisonOperator::EQ && !bitValue) {
-            intervalsMap[cmpExpr.path].neqs.push_back({cmpExpr.value, bitIndex});
+            intervalsMap[cmpExpr.path].exclusions.push_back(
+                {{&cmpExpr.value.typed()}, bitIndex});
             return true;
         } else {
             auto interval = makeInterval(cmpExpr, bitIndex, bitValue);
@@ -136,6 +267,19 @@ struct Visitor {
         }
     }
 
+    bool operator()(const Expression& expr,
+                    const InExpression& inExpr,
+                    size_t bitIndex,
+                    bool bitValue) {
+        if (inExpr.op == InOperator::NotIn) {
+            throw std::runtime_error("Unexpected negative $in operator");
+        }
+
+        auto& data = intervalsMap[inExpr.path];
+        (bitValue ? data.ins : data.exclusions).push_back({makePointSet(inExpr.values), bitIndex});
+        return true;
+    }
+
     template <typename E>
     bool operator()(const Expression& e, const E&, size_t bitIndex, bool bitValue) {
         // Ignore this expression
@@ -144,12 +288,70 @@ struct Visitor {
     }
 
     std::unordered_map<Path, IntervalData> intervalsMap{};
-    Minterm minterm{};
+    Minterm minterm;
 };
+
+// Set the literals of the path needed by the minterm, return false if the path cannot be
+// satisfied. The values of the $in are the points of the path within the interval, an excluded
+// value is retained if it is one of those points, or a point of the interval if there are no $in.
+bool simplifyPath(const IntervalData& data, Minterm& minterm) {
+    const auto& interval = data.interval;
+    const bool isPoint = interval.isPoint();
+    auto isInInterval = [&](const TypedValue* value) { return interval.contains(*value); };
+
+    PointSet points{};
+    bool keepBounds = true;
+    if (!data.ins.empty()) {
+        PointSet values = data.ins.front().values;
+        for (size_t k = 1; k < data.ins.size(); ++k) {
+            intersect(values, data.ins[k].values, lessTyped);
+        }
+        std::copy_if(begin(values), end(values), std::back_inserter(points), isInInterval);
+        if (points.empty()) {
+            return false;
+        }
+
+        // The $in imply the bounds if all their values are in the interval, a point interval
+        // implies the $in.
+        keepBounds = isPoint || points.size() != values.size();
+        if (!isPoint) {
+            auto getValues = [&](size_t k) -> const PointSet& { return data.ins[k].values; };
+            for (auto k : selectIns(data.ins.size(), getValues, lessTyped)) {
+                minterm.set(data.ins[k].bitIndex, true);
+            }
+        }
+    }
+
+    if (keepBounds && interval.left.value) {
+        minterm.set(*interval.left.bitIndex, interval.left.bitValue);
+    }
+    if (keepBounds && interval.right.value) {
+        minterm.set(*interval.right.bitIndex, interval.right.bitValue);
+    }
+
+    for (const auto& [values, bitIndex] : data.exclusions) {
+        if (!data.ins.empty()) {
+            if (intersects(values, points, lessTyped)) {
+                minterm.set(bitIndex, false);
+                subtract(points, values, lessTyped);
+                if (points.empty()) {
+                    return false;
+                }
+            }
+        } else if (std::any_of(begin(values), end(values), isInInterval)) {
+            // The excluded value is the only value of a point interval.
+            if (isPoint) {
+                return false;
+            }
+            minterm.set(bitIndex, false);
+        }
+    }
+    return true;
+}
 }  // namespace
 std::optional<Minterm> simplifyIntervals(const Minterm& minterm,
                                          const std::vector<Expression>& expressions) {
-    Visitor visitor{};
+    Visitor visitor{expressions.size()};
 
     for (size_t i = 0; i < expressions.size(); ++i) {
         if (minterm.mask[i]) {
@@ -162,31 +364,271 @@ std::optional<Minterm> simplifyIntervals(const Minterm& minterm,
 
     for (const auto& [path, intervalData] : visitor.intervalsMap) {
         // assert !intervalData.interval.empty()
-        if (intervalData.interval.left.value) {
-            visitor.minterm.set(*intervalData.interval.left.bitIndex, true);
-        }
-        if (intervalData.interval.right.value &&
-            intervalData.interval.left.value != intervalData.interval.right.value) {
-            visitor.minterm.set(*intervalData.interval.right.bitIndex, false);
-        }
-
-        for (const auto& [value, bitIndex] : intervalData.neqs) {
-            Interval pointInterval = makePointInterval(value, bitIndex);
-            // Check if NEQ value is intersected with the interval.
-            // If the intersection is not empty we have 2 options:
-            // 1. The original interval is point, then we cannot satisfy the given minterm
-            // 2. The original inteval is not point, then we have to retain the NEQ point.
-            // Otherwise, if not intersection we can simply ignore the NEQ point.
-            if (pointInterval.intersectWith(intervalData.interval)) {
-                if (intervalData.interval.isPoint()) {
-                    return std::nullopt;
-                } else {
-                    visitor.minterm.set(bitIndex, false);
+        if (!simplifyPath(intervalData, visitor.minterm)) {
+            return std::nullopt;
+        }
+    }
+
+    return visitor.minterm;
+}
+
+IntervalSimplifier::IntervalSimplifier(const std::vector<Expression>& expressions)
+    : _predicates(expressions.size()), _pointSets(expressions.size()) {
+    std::unordered_map<Path, uint32_t> pathIds{};
+    // Values of the comparisons and $in of every path with the indexes of their predicates.
+    std::vector<std::vector<std::pair<const TypedValue*, size_t>>> values{};
+    auto valuesOf = [&](const Path& path, Predicate& predicate) -> auto& {
+        auto [pos, inserted] = pathIds.try_emplace(path, static_cast<uint32_t>(values.size()));
+        if (inserted) {
+            values.emplace_back();
+        }
+        predicate.pathId = pos->second;
+        return values[pos->second];
+    };
+
+    for (size_t i = 0; i < expressions.size(); ++i) {
+        if (const auto* inExpr = expressions[i].cast<InExpression>()) {
+            auto& predicate = _predicates[i];
+            if (inExpr->op == InOperator::NotIn) {
+                predicate.kind = PredicateKind::Negative;
+                continue;
+            }
+            predicate.kind = PredicateKind::In;
+            auto& pathValues = valuesOf(inExpr->path, predicate);
+            for (const auto& value : inExpr->values) {
+                pathValues.emplace_back(&value.typed(), i);
+            }
+            continue;
+        }
+
+        const auto* cmpExpr = expressions[i].cast<ComparisonExpression>();
+        if (cmpExpr == nullptr) {
+            continue;
+        }
+
+        auto& predicate = _predicates[i];
+        switch (cmpExpr->op) {
+            case ComparisonOperator::EQ:
+                predicate.kind = PredicateKind::Eq;
+                break;
+            case ComparisonOperator::GE:
+                predicate.kind = PredicateKind::Ge;
+                break;
+            case ComparisonOperator::GT:
+                predicate.kind = PredicateKind::Gt;
+                break;
+            case ComparisonOperator::LE:
+                [[fallthrough]];
+            case ComparisonOperator::LT:
+                [[fallthrough]];
+            case ComparisonOperator::NE:
+                predicate.kind = PredicateKind::Negative;
+                continue;
+        }
+
+        valuesOf(cmpExpr->path, predicate).emplace_back(&cmpExpr->value.typed(), i);
+    }
+
+    // Equal values have equal ranks, so that the bounds are compared by their ranks.
+    for (auto& pathValues : values) {
+        std::sort(begin(pathValues), end(pathValues), [](const auto& lhs, const auto& rhs) {
+            return *lhs.first < *rhs.first;
+        });
+        uint32_t rank = 0;
+        for (size_t j = 0; j < pathValues.size(); ++j) {
+            if (j != 0 && *pathValues[j - 1].first < *pathValues[j].first) {
+                ++rank;
+            }
+            const size_t index = pathValues[j].second;
+            if (_predicates[index].kind == PredicateKind::In) {
+                _pointSets[index].push_back(rank);
+            } else {
+                _predicates[index].rank = rank;
+            }
+        }
+    }
+
+    // The ranks are pushed in the sorted order, equal values of a $in have equal ranks.
+    for (auto& ranks : _pointSets) {
+        ranks.erase(std::unique(begin(ranks), end(ranks)), end(ranks));
+    }
+    _intervals.resize(values.size());
+}
+
+IntervalSimplifier::PathInterval& IntervalSimplifier::intervalOf(const Predicate& predicate) {
+    auto& interval = _intervals[predicate.pathId];
+    if (interval.generation != _generation) {
+        // The vectors are cleared to keep their capacity for the next minterms.
+        interval.generation = _generation;
+        interval.left = {};
+        interval.right = {};
+        interval.ins.clear();
+        interval.exclusions.clear();
+        _touchedPaths.push_back(predicate.pathId);
+    }
+    return interval;
+}
+
+bool IntervalSimplifier::contains(const PathInterval& interval, uint32_t rank) const {
+    if (interval.generation != _generation) {
+        return true;
+    }
+    const auto& left = interval.left;
+    const auto& right = interval.right;
+    return (!left.isPresent || left.rank < rank || (left.rank == rank && left.isInclusive)) &&
+        (!right.isPresent || rank < right.rank || (rank == right.rank && right.isInclusive));
+}
+
+std::optional<Minterm> IntervalSimplifier::simplify(const Minterm& minterm) {
+    ++_generation;
+    _touchedPaths.clear();
+    auto result = Minterm::withSize(_predicates.size());
+
+    // The bounds are intersected in the order of the bits, the same way as Interval::intersectWith.
+    auto intersectLeft = [](Bound& left, const Bound& other) {
+        if (!left.isPresent || left.rank < other.rank ||
+            (left.rank == other.rank && left.isInclusive)) {
+            left = other;
+        }
+    };
+    auto intersectRight = [](Bound& right, const Bound& other) {
+        if (!right.isPresent || right.rank > other.rank ||
+            (right.rank == other.rank && right.isInclusive)) {
+            right = other;
+        }
+    };
+
+    bool isEmpty = false;
+    minterm.mask.forEachSetBit([&](size_t i) {
+        const auto& predicate = _predicates[i];
+        const bool bitValue = minterm.bitset[i];
+        if (isEmpty) {
+            return;
+        }
+
+        switch (predicate.kind) {
+            case PredicateKind::Other:
+                result.set(i, bitValue);
+                return;
+            case PredicateKind::In:
+                (bitValue ? intervalOf(predicate).ins : intervalOf(predicate).exclusions)
+                    .push_back(i);
+                return;
+            case PredicateKind::Negative:
+                throw std::runtime_error("Unexpected negative comparison operator");
+            case PredicateKind::Eq:
+                if (!bitValue) {
+                    intervalOf(predicate).exclusions.push_back(i);
+                    return;
                 }
+                [[fallthrough]];
+            case PredicateKind::Ge:
+                [[fallthrough]];
+            case PredicateKind::Gt:
+                break;
+        }
+
+        auto& interval = intervalOf(predicate);
+        const bool isEq = predicate.kind == PredicateKind::Eq;
+        if (isEq || bitValue) {
+            const bool isInclusive = predicate.kind != PredicateKind::Gt;
+            intersectLeft(interval.left, {true, isInclusive, true, predicate.rank, i});
+        }
+        if (isEq || !bitValue) {
+            const bool isInclusive = predicate.kind != PredicateKind::Ge;
+            intersectRight(interval.right, {true, isInclusive, isEq, predicate.rank, i});
+        }
+
+        const auto& left = interval.left;
+        const auto& right = interval.right;
+        isEmpty = left.isPresent && right.isPresent &&
+            (left.rank > right.rank ||
+             (left.rank == right.rank && (!left.isInclusive || !right.isInclusive)));
+    });
+    if (isEmpty) {
+        return std::nullopt;
+    }
+
+    for (auto pathId : _touchedPaths) {
+        if (!simplifyPath(_intervals[pathId], result)) {
+            return std::nullopt;
+        }
+    }
+    return result;
+}
+
+// Same as simplifyPath of IntervalData, on the ranks of the values.
+bool IntervalSimplifier::simplifyPath(const PathInterval& interval, Minterm& result) const {
+    const auto& left = interval.left;
+    const auto& right = interval.right;
+    const bool isPoint = left.isPresent && right.isPresent && left.rank == right.rank &&
+        left.isInclusive && right.isInclusive;
+    auto isInInterval = [&](uint32_t rank) { return contains(interval, rank); };
+    const auto less = std::less<uint32_t>{};
+
+    std::vector<uint32_t> points{};
+    bool keepBounds = true;
+    if (!interval.ins.empty()) {
+        std::vector<uint32_t> values = _pointSets[interval.ins.front()];
+        for (size_t k = 1; k < interval.ins.size(); ++k) {
+            intersect(values, _pointSets[interval.ins[k]], less);
+        }
+        std::copy_if(begin(values), end(values), std::back_inserter(points), isInInterval);
+        if (points.empty()) {
+            return false;
+        }
+
+        keepBounds = isPoint || points.size() != values.size();
+        if (!isPoint) {
+            auto getValues = [&](size_t k) -> const std::vector<uint32_t>& {
+                return _pointSets[interval.ins[k]];
+            };
+            for (auto k : selectIns(interval.ins.size(), getValues, less)) {
+                result.set(interval.ins[k], true);
             }
         }
     }
 
-    return visitor.minterm;
+    if (keepBounds && left.isPresent) {
+        result.set(left.bitIndex, left.bitValue);
+    }
+    if (keepBounds && right.isPresent) {
+        result.set(right.bitIndex, right.bitValue);
+    }
+
+    for (auto i : interval.exclusions) {
+        const auto& predicate = _predicates[i];
+        const std::array<uint32_t, 1> point{predicate.rank};
+        const std::span<const uint32_t> values = predicate.kind == PredicateKind::Eq
+            ? std::span<const uint32_t>{point}
+            : std::span<const uint32_t>{_pointSets[i]};
+        if (!interval.ins.empty()) {
+            if (intersects(values, points, less)) {
+                result.set(i, false);
+                subtract(points, values, less);
+                if (points.empty()) {
+                    return false;
+                }
+            }
+        } else if (std::any_of(begin(values), end(values), isInInterval)) {
+            if (isPoint) {
+                return false;
+            }
+            result.set(i, false);
+        }
+    }
+    return true;
+}
+
+Maxterm simplifyIntervals(const Maxterm& maxterm, const std::vector<Expression>& expressions) {
+    IntervalSimplifier simplifier{expressions};
+    Maxterm result{};
+    result.minterms.reserve(maxterm.minterms.size());
+    for (const auto& minterm : maxterm.minterms) {
+        if (auto simplified = simplifier.simplify(minterm)) {
+            result.minterms.emplace_back(std::move(*simplified));
+        }
+    }
+    return result;
 }
 }  // namespace predicate_optimizer
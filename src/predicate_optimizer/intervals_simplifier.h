@@ -2,11 +2,73 @@
 
 #include "predicate_optimizer/bitset_algebra.h"
 #include "predicate_optimizer/expression.h"
+#include <cstdint>
 #include <optional>
+#include <vector>
 
 namespace predicate_optimizer {
 // Simplify intervals in the given minterm. Return nullopt if it is detected that under no
-// conditions the mintern can be satisfied.
+// conditions the mintern can be satisfied. The values of $in are points of their path: the $in of
+// the same path are intersected with each other and with the interval, the values of cleared $in
+// and EQ are removed from them.
 std::optional<Minterm> simplifyIntervals(const Minterm& minterm,
                                          const std::vector<Expression>& expressions);
+
+/**
+ * Interval simplification of many minterms over the same predicates. The path, the kind of bound
+ * and the rank of the value among the values of the same path are computed once for every
+ * predicate, so that a minterm is simplified with integer comparisons on dense per-path arrays
+ * instead of a hash map of its paths. The values of a $in are ranked with the values of the
+ * comparisons, so that the sets of values are sorted vectors of ranks intersected by merges. The
+ * results are equal to the ones of simplifyIntervals.
+ */
+class IntervalSimplifier {
+public:
+    explicit IntervalSimplifier(const std::vector<Expression>& expressions);
+
+    std::optional<Minterm> simplify(const Minterm& minterm);
+
+private:
+    enum class PredicateKind : uint8_t { Other, Eq, Ge, Gt, In, Negative };
+
+    struct Predicate {
+        PredicateKind kind{PredicateKind::Other};
+        uint32_t pathId{0};
+        uint32_t rank{0};
+    };
+
+    struct Bound {
+        bool isPresent{false};
+        bool isInclusive{false};
+        // Value of the bit of the predicate defining the bound, see simplifyIntervals.
+        bool bitValue{false};
+        uint32_t rank{0};
+        size_t bitIndex{0};
+    };
+
+    struct PathInterval {
+        // The interval is valid for the minterm of the same generation only.
+        uint64_t generation{0};
+        Bound left;
+        Bound right;
+        // Bits of the set $in, and of the cleared EQ and $in in the order of the bits.
+        std::vector<size_t> ins;
+        std::vector<size_t> exclusions;
+    };
+
+    PathInterval& intervalOf(const Predicate& predicate);
+    bool contains(const PathInterval& interval, uint32_t rank) const;
+    bool simplifyPath(const PathInterval& interval, Minterm& result) const;
+
+    std::vector<Predicate> _predicates;
+    // Sorted and deduplicated ranks of the values of every $in, empty for other predicates.
+    std::vector<std::vector<uint32_t>> _pointSets;
+    std::vector<PathInterval> _intervals;
+    // Paths constrained by the current minterm.
+    std::vector<uint32_t> _touchedPaths;
+    uint64_t _generation{0};
+};
+
+// Simplify the intervals of every minterm of the maxterm, the unsatisfiable minterms are removed.
+Maxterm simplifyIntervals(const Maxterm& maxterm, const std::vector<Expression>& expressions);
 }  // namespace predicate_optimizer
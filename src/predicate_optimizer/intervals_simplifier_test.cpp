@@ -1,8 +1,9 @@
 #include "Catch2/catch_amalgamated.hpp"
+#include "predicate_optimizer/compiled_filter.h"
 #include "predicate_optimizer/expression_utils.h"
 #include "predicate_optimizer/intervals_simplifier.h"
 #include "predicate_optimizer/stream_utils.h"
-
+#include <random>
 
 namespace predicate_optimizer {
 TEST_CASE("intervals simplifier") {
@@ -82,6 +83,245 @@ TEST_CASE("intervals simplifier") {
 
         REQUIRE(expectedResult == actualResult);
     }
+
+    SECTION("a >= 5 && a <= 5") {
+        Minterm minterm("01", "11");
+        std::vector<Expression> expressions{
+            makeGe("a", "5"),
+            makeGt("a", "5"),
+        };
+
+        std::optional<Minterm> expectedResult{{"01", "11"}};
+
+        auto actualResult = simplifyIntervals(minterm, expressions);
+
+        REQUIRE(expectedResult == actualResult);
+    }
+
+    SECTION("a == 5 && a >= 5") {
+        std::vector<Expression> expressions{
+            makeEq("a", "5"),
+            makeGe("a", "5"),
+        };
+
+        REQUIRE(simplifyIntervals({"11", "11"}, expressions) == Minterm{"11", "11"});
+    }
+
+    SECTION("Numeric values: a > 9 && a < 10 && a >= 9.5 && b >= 10 && b < 9") {
+        Minterm minterm("10101", "11111");
+        std::vector<Expression> expressions{
+            makeGt("a", "9"),
+            makeGe("a", "10"),
+            makeGe("a", "9.5"),
+            makeGe("b", "9"),
+            makeGe("b", "10"),
+        };
+
+        REQUIRE(simplifyIntervals(minterm, expressions) == std::nullopt);
+        // a >= 10 implies a > 9 and a >= 9.5.
+        REQUIRE(simplifyIntervals({"00111", "00111"}, expressions) == Minterm{"00010", "00010"});
+    }
+
+    SECTION("a in [1, 2, 3] && a > 5") {
+        std::vector<Expression> expressions{
+            makeIn("a", {"1", "2", "3"}),
+            makeGt("a", "5"),
+        };
+
+        REQUIRE(simplifyIntervals({"11", "11"}, expressions) == std::nullopt);
+    }
+
+    SECTION("Intersected $in") {
+        std::vector<Expression> overlapping{
+            makeIn("a", {"1", "2", "3"}),
+            makeIn("a", {"2", "3", "4"}),
+        };
+        REQUIRE(simplifyIntervals({"11", "11"}, overlapping) == Minterm{"11", "11"});
+
+        // a in [1, 2] implies a in [1, 2, 3].
+        std::vector<Expression> included{
+            makeIn("a", {"1", "2"}),
+            makeIn("a", {"3", "2", "1", "1"}),
+        };
+        REQUIRE(simplifyIntervals({"11", "11"}, included) == Minterm{"01", "01"});
+
+        std::vector<Expression> disjoint{
+            makeIn("a", {"1", "2"}),
+            makeIn("a", {"3", "4"}),
+        };
+        REQUIRE(simplifyIntervals({"11", "11"}, disjoint) == std::nullopt);
+    }
+
+    SECTION("$in and bounds") {
+        // The bound is kept, a in [1, 2, 3] does not imply a >= 2.
+        std::vector<Expression> expressions{
+            makeIn("a", {"1", "2", "3"}),
+            makeGe("a", "2"),
+        };
+        REQUIRE(simplifyIntervals({"11", "11"}, expressions) == Minterm{"11", "11"});
+
+        // a in [3, 4] implies a >= 2.
+        expressions[0] = makeIn("a", {"3", "4"});
+        REQUIRE(simplifyIntervals({"11", "11"}, expressions) == Minterm{"01", "01"});
+
+        // a == 2 implies a in [1, 2.0].
+        std::vector<Expression> point{
+            makeEq("a", "2"),
+            makeIn("a", {"1", "2.0"}),
+        };
+        REQUIRE(simplifyIntervals({"11", "11"}, point) == Minterm{"01", "01"});
+        point[0] = makeEq("a", "5");
+        REQUIRE(simplifyIntervals({"11", "11"}, point) == std::nullopt);
+    }
+
+    SECTION("Excluded values") {
+        std::vector<Expression> expressions{
+            makeIn("a", {"1", "2"}),
+            makeIn("a", {"1", "2", "3"}),
+        };
+        // a in [1, 2] && a not in [1, 2, 3]
+        REQUIRE(simplifyIntervals({"01", "11"}, expressions) == std::nullopt);
+
+        expressions[1] = makeEq("a", "1");
+        REQUIRE(simplifyIntervals({"01", "11"}, expressions) == Minterm{"01", "11"});
+
+        // a != 5 is implied by a in [1, 2].
+        expressions[1] = makeEq("a", "5");
+        REQUIRE(simplifyIntervals({"01", "11"}, expressions) == Minterm{"01", "01"});
+
+        // a not in [1, 5] && a >= 3
+        std::vector<Expression> bounded{
+            makeIn("a", {"1", "5"}),
+            makeGe("a", "3"),
+        };
+        REQUIRE(simplifyIntervals({"10", "11"}, bounded) == Minterm{"10", "11"});
+
+        // a not in [1, 2] is implied by a >= 3.
+        bounded[0] = makeIn("a", {"1", "2"});
+        REQUIRE(simplifyIntervals({"10", "11"}, bounded) == Minterm{"10", "10"});
+
+        // a == 2 && a not in [1, 2]
+        bounded[1] = makeEq("a", "2");
+        REQUIRE(simplifyIntervals({"10", "11"}, bounded) == std::nullopt);
+    }
+
+    SECTION("Large $in") {
+        std::vector<Value> lhs{};
+        std::vector<Value> rhs{};
+        for (int i = 14999; i >= 0; --i) {
+            lhs.emplace_back(std::to_string(i));
+            rhs.emplace_back(std::to_string(i + 10000));
+        }
+        std::vector<Expression> expressions{
+            makeIn("a", std::move(lhs)),
+            makeIn("a", std::move(rhs)),
+            makeGe("a", "12000"),
+            makeGe("a", "15000"),
+        };
+
+        // a < 15000 is implied by a < 12000.
+        REQUIRE(simplifyIntervals({"0011", "1111"}, expressions) == Minterm{"0011", "0111"});
+        REQUIRE(simplifyIntervals({"1011", "1011"}, expressions) == std::nullopt);
+        REQUIRE(simplifyIntervals(Maxterm{{"0011", "1111"}, {"1011", "1011"}}, expressions) ==
+                Maxterm{{"0011", "0111"}});
+    }
 }
 
+TEST_CASE("Batch intervals simplifier") {
+    SECTION("Unsatisfiable minterms are removed") {
+        std::vector<Expression> expressions{
+            makeGt("a", "10"),
+            makeGe("a", "5"),
+            makeEq("a", "7"),
+            makeIn("b", {"1", "2"}),
+        };
+        Maxterm maxterm{
+            {"0011", "0011"},
+            {"1001", "1011"},
+            {"0110", "0110"},
+            {"1000", "1100"},
+        };
+
+        // a > 10 && a < 5 is removed, a == 7 implies a >= 5.
+        Maxterm expected{
+            {"0001", "0001"},
+            {"0100", "0100"},
+            {"1000", "1100"},
+        };
+
+        REQUIRE(simplifyIntervals(maxterm, expressions) == expected);
+    }
+
+    SECTION("Same results as simplifyIntervals") {
+        const std::vector<Value> values{"1", "2", "2.0", "3", "10", "1e1"};
+        std::vector<Expression> expressions{makeIn("c", {"1"})};
+        for (const char* path : {"a", "b"}) {
+            for (const auto& value : values) {
+                expressions.emplace_back(makeEq(path, value));
+                expressions.emplace_back(makeGe(path, value));
+                expressions.emplace_back(makeGt(path, value));
+            }
+            expressions.emplace_back(makeIn(path, {"1", "2", "3"}));
+            expressions.emplace_back(makeIn(path, {"3", "2.0", "10"}));
+            expressions.emplace_back(makeIn(path, {"1e1", "4"}));
+        }
+
+        std::mt19937 gen{42};
+        std::uniform_int_distribution<int> literal{0, 5};
+        Maxterm maxterm{};
+        for (size_t i = 0; i < 2000; ++i) {
+            auto& minterm = maxterm.minterms.emplace_back(Minterm::withSize(expressions.size()));
+            for (size_t bit = 0; bit < expressions.size(); ++bit) {
+                // Every predicate is a literal of a third of the minterms.
+                if (int value = literal(gen); value < 2) {
+                    minterm.set(bit, value == 1);
+                }
+            }
+        }
+
+        Maxterm expected{};
+        for (const auto& minterm : maxterm.minterms) {
+            if (auto simplified = simplifyIntervals(minterm, expressions)) {
+                expected.minterms.emplace_back(std::move(*simplified));
+            }
+        }
+
+        auto actual = simplifyIntervals(maxterm, expressions);
+        REQUIRE(!actual.minterms.empty());
+        REQUIRE(actual == expected);
+    }
+
+    SECTION("Simplified minterms are equivalent") {
+        std::vector<Expression> expressions{
+            makeEq("a", "2"),
+            makeGe("a", "2"),
+            makeGt("a", "3"),
+            makeEq("a", "5"),
+            makeIn("a", {"1", "2", "3"}),
+            makeIn("a", {"2.0", "3", "5"}),
+            makeIn("a", {"5", "6"}),
+            makeIn("a", {"1", "6"}),
+        };
+        const std::vector<Value> values{"0", "1", "1.5", "2", "2.5", "3", "4", "5", "6", "7"};
+
+        std::mt19937 gen{42};
+        std::uniform_int_distribution<int> literal{0, 3};
+        for (size_t i = 0; i < 2000; ++i) {
+            auto minterm = Minterm::withSize(expressions.size());
+            for (size_t bit = 0; bit < expressions.size(); ++bit) {
+                if (int value = literal(gen); value < 2) {
+                    minterm.set(bit, value == 1);
+                }
+            }
+
+            CompiledFilter original{Maxterm{minterm}, expressions};
+            CompiledFilter simplified{simplifyIntervals(Maxterm{minterm}, expressions),
+                                      expressions};
+            for (const auto& value : values) {
+                Document document{{"a", value}};
+                REQUIRE(original.matches(document) == simplified.matches(document));
+            }
+        }
+    }
+}
 }  // namespace predicate_optimizer
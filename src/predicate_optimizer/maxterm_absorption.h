@@ -0,0 +1,128 @@
+#pragma once
+
+#include "predicate_optimizer/bitset_algebra.h"
+#include <optional>
+#include <unordered_set>
+#include <vector>
+
+namespace predicate_optimizer {
+/**
+ * A Maxterm which is kept free of duplicate and absorbed minterms while it is built: a minterm is
+ * not added if a present minterm has a subset of its literals (a | ab == a), and adding a minterm
+ * removes the present minterms whose literals are a superset of its own. Minterms are grouped by
+ * the number of literals, so that only the groups which can absorb or be absorbed are scanned, and
+ * duplicates are found by hash lookup.
+ */
+template <typename BitsetT>
+class AbsorbingMaxterm {
+public:
+    using MintermType = BasicMinterm<BitsetT>;
+    using MaxtermType = BasicMaxterm<BitsetT>;
+
+    AbsorbingMaxterm() {}
+
+    explicit AbsorbingMaxterm(const MaxtermType& maxterm) {
+        for (const auto& minterm : maxterm.minterms) {
+            insert(minterm);
+        }
+    }
+
+    // Add the minterm unless it is absorbed. Return true if the minterm was added.
+    bool insert(MintermType minterm) {
+        if (_present.contains(minterm)) {
+            return false;
+        }
+
+        const size_t numLiterals = minterm.mask.count();
+        for (size_t k = 0; k < std::min(numLiterals, _groups.size()); ++k) {
+            for (size_t index : _groups[k]) {
+                if (_minterms[index]->absorbs(minterm)) {
+                    return false;
+                }
+            }
+        }
+
+        for (size_t k = numLiterals + 1; k < _groups.size(); ++k) {
+            auto& group = _groups[k];
+            size_t pos = 0;
+            while (pos < group.size()) {
+                auto& current = _minterms[group[pos]];
+                if (minterm.absorbs(*current)) {
+                    _present.erase(*current);
+                    current.reset();
+                    group[pos] = group.back();
+                    group.pop_back();
+                } else {
+                    ++pos;
+                }
+            }
+        }
+
+        if (_groups.size() <= numLiterals) {
+            _groups.resize(numLiterals + 1);
+        }
+        _groups[numLiterals].push_back(_minterms.size());
+        _present.insert(minterm);
+        _minterms.emplace_back(std::move(minterm));
+        return true;
+    }
+
+    void insert(const MaxtermType& maxterm) {
+        for (const auto& minterm : maxterm.minterms) {
+            insert(minterm);
+        }
+    }
+
+    size_t size() const {
+        return _present.size();
+    }
+
+    // Return the remaining minterms in the order they were added.
+    MaxtermType release() && {
+        MaxtermType result{};
+        result.minterms.reserve(_present.size());
+        for (auto& minterm : _minterms) {
+            if (minterm) {
+                result.minterms.emplace_back(std::move(*minterm));
+            }
+        }
+        return result;
+    }
+
+private:
+    // Minterms in the order of insertion, absorbed ones are reset.
+    std::vector<std::optional<MintermType>> _minterms;
+    // Indexes of the present minterms grouped by the number of literals.
+    std::vector<std::vector<size_t>> _groups;
+    std::unordered_set<MintermType> _present;
+};
+
+// Conjunction of the maxterms which removes duplicate and absorbed products as they are formed.
+template <typename BitsetT>
+BasicMaxterm<BitsetT> absorbingProduct(const BasicMaxterm<BitsetT>& lhs,
+                                       const BasicMaxterm<BitsetT>& rhs) {
+    AbsorbingMaxterm<BitsetT> result{};
+    for (const auto& left : lhs.minterms) {
+        for (const auto& right : rhs.minterms) {
+            if (left.getConflicts(right).none()) {
+                result.insert({left.bitset | right.bitset, left.mask | right.mask});
+            }
+        }
+    }
+    return std::move(result).release();
+}
+
+// Complement of the maxterm built by absorbing products of the complemented minterms.
+template <typename BitsetT>
+BasicMaxterm<BitsetT> absorbingComplement(const BasicMaxterm<BitsetT>& maxterm) {
+    if (maxterm.minterms.empty()) {
+        return {BasicMinterm<BitsetT>{}};
+    }
+
+    auto result = ~maxterm.minterms.front();
+    for (size_t i = 1; i < maxterm.minterms.size(); ++i) {
+        result = absorbingProduct(result, ~maxterm.minterms[i]);
+    }
+    return result;
+}
+}  // namespace predicate_optimizer
@@ -0,0 +1,75 @@
+#include "Catch2/catch_amalgamated.hpp"
+#include "predicate_optimizer/maxterm_absorption.h"
+
+namespace predicate_optimizer {
+TEST_CASE("Absorbing Maxterm") {
+    SECTION("AB | A = A") {
+        AbsorbingMaxterm<Bitset> maxterm{};
+        REQUIRE(maxterm.insert({"11", "11"}));
+        REQUIRE(maxterm.insert({"01", "01"}));
+        REQUIRE(maxterm.size() == 1);
+
+        Maxterm expectedResult{{"01", "01"}};
+        REQUIRE(expectedResult == std::move(maxterm).release());
+    }
+
+    SECTION("A | AB | A = A") {
+        AbsorbingMaxterm<Bitset> maxterm{};
+        REQUIRE(maxterm.insert({"01", "01"}));
+        REQUIRE_FALSE(maxterm.insert({"11", "11"}));
+        REQUIRE_FALSE(maxterm.insert({"01", "01"}));
+
+        Maxterm expectedResult{{"01", "01"}};
+        REQUIRE(expectedResult == std::move(maxterm).release());
+    }
+
+    SECTION("A~B | ~AB | B~C | C") {
+        AbsorbingMaxterm<Bitset> maxterm{Maxterm{
+            {"001", "011"},
+            {"010", "011"},
+            {"010", "110"},
+            {"100", "100"},
+        }};
+
+        // ~AB and B~C are not absorbed by C since they have different literals.
+        Maxterm expectedResult{
+            {"001", "011"},
+            {"010", "011"},
+            {"010", "110"},
+            {"100", "100"},
+        };
+        REQUIRE(expectedResult == std::move(maxterm).release());
+    }
+
+    SECTION("A~B | ~AB | BC | C = A~B | ~AB | C") {
+        AbsorbingMaxterm<Bitset> maxterm{Maxterm{
+            {"001", "011"},
+            {"010", "011"},
+            {"110", "110"},
+            {"100", "100"},
+        }};
+
+        Maxterm expectedResult{
+            {"001", "011"},
+            {"010", "011"},
+            {"100", "100"},
+        };
+        REQUIRE(expectedResult == std::move(maxterm).release());
+    }
+
+    SECTION("(A | B) & (A | C) = A | BC") {
+        Maxterm a_b{{"001", "001"}, {"010", "010"}};
+        Maxterm a_c{{"001", "001"}, {"100", "100"}};
+
+        Maxterm expectedResult{{"001", "001"}, {"110", "110"}};
+        REQUIRE(expectedResult == absorbingProduct(a_b, a_c));
+    }
+
+    SECTION("~(A | B) = ~A~B") {
+        Maxterm a_b{{"01", "01"}, {"10", "10"}};
+
+        Maxterm expectedResult{{"00", "11"}};
+        REQUIRE(expectedResult == absorbingComplement(a_b));
+    }
+}
+}  // namespace predicate_optimizer
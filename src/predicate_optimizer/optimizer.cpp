@@ -0,0 +1,183 @@
+#include "predicate_optimizer/optimizer.h"
+#include "predicate_optimizer/expression_arena.h"
+#include "predicate_optimizer/expression_reconstruction.h"
+#include "predicate_optimizer/expression_rewrite.h"
+#include "predicate_optimizer/intervals_simplifier.h"
+
+#include <algorithm>
+#include <optional>
+#include <ostream>
+
+namespace predicate_optimizer {
+namespace {
+// Adds the wall time of its lifetime to the time of the stage.
+class StageTimer {
+public:
+    StageTimer(OptimizerStats& stats, OptimizerStage stage)
+        : _time(stats.stageTimes[static_cast<size_t>(stage)]),
+          _start(std::chrono::steady_clock::now()) {}
+
+    ~StageTimer() {
+        _time += std::chrono::steady_clock::now() - _start;
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    std::chrono::steady_clock::duration& _time;
+    std::chrono::steady_clock::time_point _start;
+};
+
+// Estimated size of the given number of minterms of the given number of predicates, the same
+// estimation as the one of the normal form budget.
+size_t mintermsBytes(size_t numMinterms, size_t numPredicates) {
+    const size_t mintermBytes =
+        sizeof(Minterm) + 2 * Bitset::wordsFor(numPredicates) * sizeof(Bitset::Word);
+    return saturatingMultiply(numMinterms, mintermBytes);
+}
+
+// Total number of literals of the implicants of the cover.
+size_t countLiterals(const std::vector<unsigned>& cover, const std::vector<QMCResult>& implicants) {
+    size_t numLiterals = 0;
+    for (auto index : cover) {
+        numLiterals += implicants[index].minterm.mask.count();
+    }
+    return numLiterals;
+}
+
+// Return the cover with the fewest implicants, and the fewest literals among those.
+const std::vector<unsigned>& selectSmallestCover(const std::vector<std::vector<unsigned>>& covers,
+                                                 const std::vector<QMCResult>& implicants) {
+    return *std::min_element(begin(covers), end(covers), [&](const auto& lhs, const auto& rhs) {
+        if (lhs.size() != rhs.size()) {
+            return lhs.size() < rhs.size();
+        }
+        return countLiterals(lhs, implicants) < countLiterals(rhs, implicants);
+    });
+}
+}  // namespace
+
+std::chrono::steady_clock::duration OptimizerStats::totalTime() const {
+    std::chrono::steady_clock::duration total{};
+    for (const auto& time : stageTimes) {
+        total += time;
+    }
+    return total;
+}
+
+OptimizeResult optimize(Expression expr, const OptimizerOptions& options) {
+    OptimizerStats stats{};
+
+    // The intermediate trees and the predicates are allocated from the arena, it is destroyed
+    // after them. The result is reconstructed on the heap once the scope is reset.
+    ExpressionArena arena{};
+    std::optional<ExpressionArena::Scope> arenaScope{arena};
+
+    Expression positive = [&]() {
+        StageTimer timer{stats, OptimizerStage::RemoveNot};
+        return removeNotExpressions(expr);
+    }();
+
+    auto normalForm = [&]() {
+        StageTimer timer{stats, OptimizerStage::NormalForm};
+        return tryTransformToNormalForm(std::move(positive), options.normalForm);
+    }();
+    if (normalForm.status != ExpansionStatus::Ok) {
+        return {normalForm.status, std::move(expr), stats};
+    }
+    arenaScope.reset();
+
+    const auto& expressions = normalForm.expressions;
+    stats.numPredicates = expressions.size();
+    stats.numMinterms = normalForm.maxterm.minterms.size();
+    stats.peakBytes = mintermsBytes(stats.numMinterms, stats.numPredicates);
+
+    std::vector<Minterm> minterms{};
+    if (options.simplifyIntervals) {
+        StageTimer timer{stats, OptimizerStage::SimplifyIntervals};
+        minterms = simplifyIntervals(normalForm.maxterm, expressions).minterms;
+    } else {
+        minterms = std::move(normalForm.maxterm.minterms);
+    }
+    stats.numSimplifiedMinterms = minterms.size();
+
+    std::vector<QMCResult> implicants{};
+    if (!minterms.empty()) {
+        StageTimer timer{stats, OptimizerStage::QuineMcCluskey};
+        auto primeImplicants = quine_mccluskey(std::move(minterms), options.qmc);
+        implicants.assign(std::make_move_iterator(begin(primeImplicants)),
+                          std::make_move_iterator(end(primeImplicants)));
+        // The order of the prime implicants follows the order of the minterms they cover, so that
+        // the result does not depend on the order of the unordered set.
+        std::sort(begin(implicants), end(implicants), [](const auto& lhs, const auto& rhs) {
+            return lhs.coveredMinterms < rhs.coveredMinterms;
+        });
+    }
+    stats.numPrimeImplicants = implicants.size();
+    size_t implicantsBytes = mintermsBytes(implicants.size(), stats.numPredicates);
+    for (const auto& implicant : implicants) {
+        implicantsBytes += implicant.coveredMinterms.size() * sizeof(unsigned);
+    }
+    stats.peakBytes = std::max(stats.peakBytes, implicantsBytes);
+
+    std::vector<unsigned> cover{};
+    if (!implicants.empty()) {
+        StageTimer timer{stats, OptimizerStage::SelectCover};
+        std::vector<std::vector<unsigned>> coverage{};
+        // The number of literals of every implicant, a cheaper implicant is not dropped for a
+        // costlier one covering the same minterms.
+        std::vector<size_t> costs{};
+        coverage.reserve(implicants.size());
+        costs.reserve(implicants.size());
+        for (const auto& implicant : implicants) {
+            coverage.emplace_back(implicant.coveredMinterms);
+            costs.push_back(implicant.minterm.mask.count());
+        }
+
+        const auto covers = predicate_optimization::selectCover(coverage, options.cover, costs);
+        if (!covers.empty()) {
+            cover = selectSmallestCover(covers, implicants);
+        }
+    }
+    stats.numSelectedImplicants = cover.size();
+
+    auto optimized = [&]() {
+        StageTimer timer{stats, OptimizerStage::Reconstruct};
+        return reconstructExpression(implicants, cover, expressions);
+    }();
+    return {ExpansionStatus::Ok, std::move(optimized), stats};
+}
+
+std::ostream& operator<<(std::ostream& os, OptimizerStage stage) {
+    switch (stage) {
+        case OptimizerStage::RemoveNot:
+            return os << "RemoveNot";
+        case OptimizerStage::NormalForm:
+            return os << "NormalForm";
+        case OptimizerStage::SimplifyIntervals:
+            return os << "SimplifyIntervals";
+        case OptimizerStage::QuineMcCluskey:
+            return os << "QuineMcCluskey";
+        case OptimizerStage::SelectCover:
+            return os << "SelectCover";
+        case OptimizerStage::Reconstruct:
+            return os << "Reconstruct";
+    }
+    __builtin_unreachable();
+}
+
+std::ostream& operator<<(std::ostream& os, const OptimizerStats& stats) {
+    os << "predicates: " << stats.numPredicates << ", minterms: " << stats.numMinterms
+       << ", simplified minterms: " << stats.numSimplifiedMinterms
+       << ", prime implicants: " << stats.numPrimeImplicants
+       << ", selected implicants: " << stats.numSelectedImplicants
+       << ", peak bytes: " << stats.peakBytes;
+    for (size_t i = 0; i < kNumOptimizerStages; ++i) {
+        os << ", " << static_cast<OptimizerStage>(i) << ": "
+           << std::chrono::duration_cast<std::chrono::microseconds>(stats.stageTimes[i]).count()
+           << "us";
+    }
+    return os;
+}
+}  // namespace predicate_optimizer
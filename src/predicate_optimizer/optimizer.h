@@ -0,0 +1,71 @@
+#pragma once
+
+#include "predicate_optimizer/cover_selection.h"
+#include "predicate_optimizer/expansion_budget.h"
+#include "predicate_optimizer/expression.h"
+#include "predicate_optimizer/expression_dnf.h"
+#include "predicate_optimizer/quine_mccluskey.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+
+namespace predicate_optimizer {
+enum class OptimizerStage {
+    RemoveNot,
+    NormalForm,
+    SimplifyIntervals,
+    QuineMcCluskey,
+    SelectCover,
+    Reconstruct,
+};
+
+constexpr size_t kNumOptimizerStages = static_cast<size_t>(OptimizerStage::Reconstruct) + 1;
+
+struct OptimizerOptions {
+    NormalFormOptions normalForm{.pruneContradictions = true};
+    // Drop unsatisfiable minterms and redundant comparisons of the same path, see
+    // simplifyIntervals.
+    bool simplifyIntervals{true};
+    QmcOptions qmc{};
+    predicate_optimization::CoverOptions cover{};
+};
+
+struct OptimizerStats {
+    // Wall time of every stage, indexed by OptimizerStage. Stages which did not run take no time.
+    std::array<std::chrono::steady_clock::duration, kNumOptimizerStages> stageTimes{};
+    // Number of distinct leaf predicates, the bits of the minterms.
+    size_t numPredicates{0};
+    // Minterms of the normal form, and the satisfiable ones left by the interval simplification.
+    size_t numMinterms{0};
+    size_t numSimplifiedMinterms{0};
+    // Prime implicants found by Quine-McCluskey, and the ones of the selected cover.
+    size_t numPrimeImplicants{0};
+    size_t numSelectedImplicants{0};
+    // Estimated size of the largest intermediate result of the stages, in bytes.
+    size_t peakBytes{0};
+
+    std::chrono::steady_clock::duration stageTime(OptimizerStage stage) const {
+        return stageTimes[static_cast<size_t>(stage)];
+    }
+
+    std::chrono::steady_clock::duration totalTime() const;
+};
+
+struct OptimizeResult {
+    ExpansionStatus status;
+    // The minimized expression, or the original one if the budget was exhausted.
+    Expression expression;
+    OptimizerStats stats;
+};
+
+/* Minimize the expression: remove the negations, transform it to the normal form, simplify the
+ * intervals of its minterms, find the prime implicants by Quine-McCluskey, select a cover of the
+ * minterms with the fewest implicants and convert it back to an $or of $ands, see
+ * reconstructExpression. The expansion to the normal form is limited by the budget of the options,
+ * if it is exhausted the original expression is returned with the status of the exceeded limit.*/
+OptimizeResult optimize(Expression expr, const OptimizerOptions& options = {});
+
+std::ostream& operator<<(std::ostream& os, OptimizerStage stage);
+std::ostream& operator<<(std::ostream& os, const OptimizerStats& stats);
+}  // namespace predicate_optimizer
@@ -0,0 +1,107 @@
+#include "Catch2/catch_amalgamated.hpp"
+#include "expression_utils.h"
+#include "optimizer.h"
+
+namespace predicate_optimizer {
+TEST_CASE("Optimize", "") {
+    SECTION("Adjacent minterms are combined") {
+        auto expr = makeOr({
+            makeAnd({makeEq("a", "1"), makeEq("b", "1")}),
+            makeAnd({makeEq("a", "1"), makeNot(makeEq("b", "1"))}),
+        });
+
+        auto result = optimize(std::move(expr));
+
+        REQUIRE(result.status == ExpansionStatus::Ok);
+        REQUIRE(result.expression == makeEq("a", "1"));
+        REQUIRE(result.stats.numPredicates == 2);
+        REQUIRE(result.stats.numMinterms == 2);
+        REQUIRE(result.stats.numSimplifiedMinterms == 2);
+        REQUIRE(result.stats.numPrimeImplicants == 1);
+        REQUIRE(result.stats.numSelectedImplicants == 1);
+        REQUIRE(result.stats.peakBytes > 0);
+    }
+
+    SECTION("Negated predicates are restored") {
+        auto expr = makeOr({
+            makeAnd({makeLt("a", "5"), makeNe("b", "1")}),
+            makeAnd({makeLt("a", "5"), makeNotIn("c", {"1", "2"})}),
+        });
+
+        auto result = optimize(expr);
+
+        REQUIRE(result.expression == expr);
+        REQUIRE(result.stats.numPrimeImplicants == 2);
+    }
+
+    SECTION("Unsatisfiable minterms are removed") {
+        auto expr = makeOr({
+            makeAnd({makeGt("a", "5"), makeLt("a", "3")}),
+            makeAnd({makeEq("a", "1"), makeEq("a", "2")}),
+        });
+
+        auto result = optimize(expr, {.normalForm = {.pruneContradictions = false}});
+
+        REQUIRE(result.expression == makeOr({}));
+        REQUIRE(result.stats.numMinterms == 2);
+        REQUIRE(result.stats.numSimplifiedMinterms == 0);
+        REQUIRE(result.stats.numSelectedImplicants == 0);
+
+        // The contradictions are pruned while the normal form is built.
+        auto pruned = optimize(std::move(expr));
+
+        REQUIRE(pruned.expression == makeOr({}));
+        REQUIRE(pruned.stats.numMinterms == 0);
+    }
+
+    SECTION("Redundant implicants are not selected") {
+        // The cyclic function of the minterms 0, 1, 2, 5, 6 and 7 of a, b and c has six prime
+        // implicants, three of which cover it.
+        auto makeMinterm = [](unsigned index) {
+            std::vector<Expression> literals{};
+            for (const char* path : {"a", "b", "c"}) {
+                index <<= 1;
+                literals.emplace_back(index & 8 ? makeEq(path, "1") : makeNe(path, "1"));
+            }
+            return makeAnd(std::move(literals));
+        };
+        auto expr = makeOr({makeMinterm(0),
+                            makeMinterm(1),
+                            makeMinterm(2),
+                            makeMinterm(5),
+                            makeMinterm(6),
+                            makeMinterm(7)});
+
+        auto result = optimize(std::move(expr), {.simplifyIntervals = false});
+
+        REQUIRE(result.stats.numMinterms == 6);
+        REQUIRE(result.stats.numPrimeImplicants == 6);
+        REQUIRE(result.stats.numSelectedImplicants == 3);
+        REQUIRE(result.stats.stageTime(OptimizerStage::SimplifyIntervals).count() == 0);
+    }
+
+    SECTION("Exhausted budget") {
+        auto expr = makeAnd({
+            makeOr({makeEq("a", "1"), makeEq("a", "2")}),
+            makeOr({makeEq("b", "1"), makeEq("b", "2")}),
+        });
+
+        auto result = optimize(expr, {.normalForm = {.budget = {.maxMinterms = 3}}});
+
+        REQUIRE(result.status == ExpansionStatus::MintermLimitExceeded);
+        REQUIRE(result.expression == expr);
+        REQUIRE(result.stats.numMinterms == 0);
+    }
+
+    SECTION("Stage times") {
+        auto result = optimize(makeAnd({makeEq("a", "1"), makeNot(makeEq("b", "1"))}));
+
+        std::chrono::steady_clock::duration total{};
+        for (size_t i = 0; i < kNumOptimizerStages; ++i) {
+            total += result.stats.stageTime(static_cast<OptimizerStage>(i));
+        }
+        REQUIRE(result.stats.totalTime() == total);
+        REQUIRE(result.stats.stageTime(OptimizerStage::NormalForm).count() > 0);
+    }
+}
+}  // namespace predicate_optimizer
@@ -1,41 +1,22 @@
 #include "petrick.h"
-#include <bitset>
+#include "predicate_optimizer/cover_table.h"
 #include <cassert>
 namespace predicate_optimization {
 namespace {
-using Implicant = std::bitset<64>;
+// Set of implicant indexes, sized for all implicants of the table.
+using Implicant = Bitset;
 
 // Return true if lhs is a non-strict subset of rhs.
 bool isSubset(const Implicant& lhs, const Implicant& rhs) {
-    return (lhs & rhs) == lhs;
+    return lhs.isSubsetOf(rhs);
 }
 
-Implicant makeImplicant(size_t implicantIndex) {
-    Implicant implicant{};
+Implicant makeImplicant(size_t implicantIndex, size_t numImplicants) {
+    Implicant implicant = Implicant::zeros(numImplicants);
     implicant.set(implicantIndex);
     return implicant;
 }
 
-struct ImplicantTable {
-    explicit ImplicantTable(const std::vector<std::vector<unsigned>>& data) {
-        for (size_t implicantIndex = 0; implicantIndex < data.size(); ++implicantIndex) {
-            for (auto mintermIndex : data[implicantIndex]) {
-                insert(mintermIndex, implicantIndex);
-            }
-        }
-    }
-
-    void insert(size_t mintermIndex, size_t implicantIndex) {
-        if (table.size() <= mintermIndex) {
-            table.resize(mintermIndex + 1);
-        }
-
-        table[mintermIndex].emplace_back(makeImplicant(implicantIndex));
-    };
-
-    std::vector<std::vector<Implicant>> table;
-};
-
 void insertImplicant(std::vector<Implicant>& list, Implicant implicant) {
     size_t listSize = list.size();
     size_t pos = 0;
@@ -82,30 +63,46 @@ std::vector<Implicant> product(const std::vector<Implicant>& lhs,
 }
 
 std::vector<unsigned> getListOfSetBits(const Implicant& implicant) {
-    auto value = implicant.to_ullong();
     std::vector<unsigned> result{};
-    for (size_t i = 0; i < implicant.size(); ++i) {
-        if (implicant[i]) {
-            result.emplace_back(i);
-        }
-    }
+    implicant.forEachSetBit([&](size_t i) { result.emplace_back(i); });
     return result;
 }
 }  // namespace
-std::vector<std::vector<unsigned>> petrick(const std::vector<std::vector<unsigned>>& data) {
-    ImplicantTable table{data};
+std::vector<std::vector<unsigned>> petrick(const std::vector<std::vector<unsigned>>& data,
+                                           const std::vector<size_t>& costs) {
+    CoverTable coverTable{data, costs};
+    if (coverTable.hasUncoveredMinterms()) {
+        return {};
+    }
+    coverTable.reduce();
+
+    // Petrick's product of sums over the cyclic core.
+    std::vector<std::vector<Implicant>> table{};
+    coverTable.activeMinterms.forEachSetBit([&](size_t mintermIndex) {
+        auto& sum = table.emplace_back();
+        coverTable.implicantsOf[mintermIndex].forEachSetBit([&](size_t implicantIndex) {
+            sum.emplace_back(makeImplicant(implicantIndex, coverTable.numImplicants));
+        });
+    });
+
+    while (table.size() >= 2) {
+        size_t size = table.size();
+        auto production = product(table[size - 1], table[size - 2]);
+        table.pop_back();
+        table[table.size() - 1].swap(production);
+    }
 
-    while (table.table.size() >= 2) {
-        size_t size = table.table.size();
-        auto production = product(table.table[size - 1], table.table[size - 2]);
-        table.table.pop_back();
-        table.table[table.table.size() - 1].swap(production);
+    if (table.empty()) {
+        table.push_back({Implicant::zeros(coverTable.numImplicants)});
     }
 
     std::vector<std::vector<unsigned>> result{};
-    result.reserve(table.table.front().size());
+    result.reserve(table.front().size());
 
-    for (const auto& implicant : table.table.front()) {
+    for (auto& implicant : table.front()) {
+        for (auto essential : coverTable.essentials) {
+            implicant.set(essential);
+        }
         result.emplace_back(getListOfSetBits(implicant));
     }
 
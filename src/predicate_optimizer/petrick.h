@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
 namespace predicate_optimization {
@@ -7,6 +8,11 @@ namespace predicate_optimization {
  * Takes a coverage list of input to MQ minterms. Every element of outer vector represent the
  * coverage of the output minterm and contains indexes of the covered input minterms. Returns a list
  * of lists of output minterms, where every internal list covers all input minterms.
+ * Essential output minterms are selected and dominated rows and columns of the covering table are
+ * removed first, so the product of sums only runs on the cyclic core of the table. A row is only
+ * removed for a row costing no more, see CoverTable, so the result contains a cover of the fewest
+ * output minterms with the lowest total cost among those, but not every irredundant cover.
  */
-std::vector<std::vector<unsigned>> petrick(const std::vector<std::vector<unsigned>>& data);
+std::vector<std::vector<unsigned>> petrick(const std::vector<std::vector<unsigned>>& data,
+                                           const std::vector<size_t>& costs = {});
 }  // namespace predicate_optimization
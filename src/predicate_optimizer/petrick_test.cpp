@@ -24,4 +24,67 @@ TEST_CASE("Petrick", "") {
     auto result = petrick(data);
     REQUIRE(expectedResult == result);
 }
+
+TEST_CASE("Petrick with essential implicants", "") {
+    std::vector<std::vector<unsigned>> data{
+        {0, 1},
+        {0, 3},
+        {1, 2},
+        {3, 4},
+        {2, 5},
+        {4, 5},
+        {0, 6},
+    };
+
+    // The implicants 4 and 5 cover the same minterm once the others are selected, both covers
+    // are minimal.
+    std::vector<std::vector<unsigned>> expectedResult{
+        {2, 3, 4, 6},
+        {2, 3, 5, 6},
+    };
+
+    auto result = petrick(data);
+    REQUIRE(expectedResult == result);
+}
+
+TEST_CASE("Petrick with implicant costs", "") {
+    std::vector<std::vector<unsigned>> data{
+        {0, 1},
+        {0},
+        {1},
+    };
+
+    // The cheap implicants 1 and 2 are not dropped for the costlier implicant 0.
+    REQUIRE(petrick(data, {3, 1, 1}) == std::vector<std::vector<unsigned>>{{0}, {1, 2}});
+    REQUIRE(petrick(data, {1, 1, 1}) == std::vector<std::vector<unsigned>>{{0}});
+    REQUIRE(petrick({{0}, {0}}, {2, 1}) == std::vector<std::vector<unsigned>>{{1}});
+    REQUIRE(petrick({{0}, {0}}) == std::vector<std::vector<unsigned>>{{0}, {1}});
+}
+
+TEST_CASE("Petrick with more than 64 implicants", "") {
+    std::vector<std::vector<unsigned>> data{};
+    for (unsigned i = 0; i < 100; ++i) {
+        data.push_back({i});
+    }
+    data.push_back({0, 1});
+
+    std::vector<unsigned> expectedCover{};
+    for (unsigned i = 2; i <= 100; ++i) {
+        expectedCover.push_back(i);
+    }
+    std::vector<std::vector<unsigned>> expectedResult{expectedCover};
+
+    auto result = petrick(data);
+    REQUIRE(expectedResult == result);
+}
+
+TEST_CASE("Petrick with an uncovered minterm", "") {
+    std::vector<std::vector<unsigned>> data{
+        {0},
+        {2},
+    };
+
+    auto result = petrick(data);
+    REQUIRE(result.empty());
+}
 }  // namespace predicate_optimization
@@ -0,0 +1,137 @@
+#include "predicate_optimizer/predicate_implications.h"
+
+#include <unordered_map>
+
+namespace predicate_optimizer {
+namespace {
+// Bound of an interval, a null value is an infinite bound.
+struct Bound {
+    const TypedValue* value{nullptr};
+    bool isInclusive{false};
+};
+
+// Values satisfying a literal of a comparison: an interval, or all values but a point for a
+// negated EQ.
+struct LiteralSet {
+    bool isCoPoint{false};
+    Bound lower{};
+    Bound upper{};
+
+    static LiteralSet make(const ComparisonExpression& expr, bool value) {
+        const auto* operand = &expr.value.typed();
+        switch (expr.op) {
+            case ComparisonOperator::EQ:
+                if (value) {
+                    return {false, {operand, true}, {operand, true}};
+                }
+                return {true, {operand, true}, {operand, true}};
+            case ComparisonOperator::GE:
+                return value ? LiteralSet{false, {operand, true}, {}}
+                             : LiteralSet{false, {}, {operand, false}};
+            case ComparisonOperator::GT:
+                return value ? LiteralSet{false, {operand, false}, {}}
+                             : LiteralSet{false, {}, {operand, true}};
+            case ComparisonOperator::LE:
+                return value ? LiteralSet{false, {}, {operand, true}}
+                             : LiteralSet{false, {operand, false}, {}};
+            case ComparisonOperator::LT:
+                return value ? LiteralSet{false, {}, {operand, false}}
+                             : LiteralSet{false, {operand, true}, {}};
+            case ComparisonOperator::NE:
+                return make({ComparisonOperator::EQ, expr.path, expr.value}, !value);
+        }
+        __builtin_unreachable();
+    }
+
+    bool contains(const TypedValue& value) const {
+        return isAboveLower(value) && isBelowUpper(value);
+    }
+
+    bool isAboveLower(const TypedValue& value) const {
+        if (lower.value == nullptr) {
+            return true;
+        }
+        const auto cmp = value <=> *lower.value;
+        return cmp > 0 || (cmp == 0 && lower.isInclusive);
+    }
+
+    bool isBelowUpper(const TypedValue& value) const {
+        if (upper.value == nullptr) {
+            return true;
+        }
+        const auto cmp = value <=> *upper.value;
+        return cmp < 0 || (cmp == 0 && upper.isInclusive);
+    }
+
+    // Return true if every value of this set belongs to the other one. All values but a point
+    // are never a subset of an interval, every interval has values outside of it.
+    bool isSubsetOf(const LiteralSet& other) const {
+        if (isCoPoint) {
+            return other.isCoPoint && *lower.value == *other.lower.value;
+        }
+        if (other.isCoPoint) {
+            return !contains(*other.lower.value);
+        }
+        return isLowerWithin(other.lower) && isUpperWithin(other.upper);
+    }
+
+    bool isLowerWithin(const Bound& other) const {
+        if (other.value == nullptr) {
+            return true;
+        }
+        if (lower.value == nullptr) {
+            return false;
+        }
+        const auto cmp = *lower.value <=> *other.value;
+        return cmp > 0 || (cmp == 0 && (other.isInclusive || !lower.isInclusive));
+    }
+
+    bool isUpperWithin(const Bound& other) const {
+        if (other.value == nullptr) {
+            return true;
+        }
+        if (upper.value == nullptr) {
+            return false;
+        }
+        const auto cmp = *upper.value <=> *other.value;
+        return cmp < 0 || (cmp == 0 && (other.isInclusive || !upper.isInclusive));
+    }
+};
+}  // namespace
+
+PredicateImplications::PredicateImplications(const std::vector<Expression>& predicates)
+    : _implied(2 * predicates.size()) {
+    // Indexes of the comparisons of every path.
+    std::unordered_map<Path, std::vector<size_t>> paths{};
+    for (size_t i = 0; i < predicates.size(); ++i) {
+        if (const auto* expr = predicates[i].cast<ComparisonExpression>()) {
+            paths[expr->path].push_back(i);
+        }
+    }
+
+    for (const auto& [path, indexes] : paths) {
+        if (indexes.size() < 2 || indexes.size() > kMaxPredicatesPerPath) {
+            continue;
+        }
+
+        // The literals of the comparisons of the path, the literal (i, value) at 2 * k + value.
+        std::vector<LiteralSet> literals{};
+        literals.reserve(2 * indexes.size());
+        for (auto index : indexes) {
+            const auto& expr = *predicates[index].cast<ComparisonExpression>();
+            literals.push_back(LiteralSet::make(expr, false));
+            literals.push_back(LiteralSet::make(expr, true));
+        }
+
+        for (size_t lhs = 0; lhs < literals.size(); ++lhs) {
+            auto& implied = _implied[2 * indexes[lhs / 2] + lhs % 2];
+            for (size_t rhs = 0; rhs < literals.size(); ++rhs) {
+                if (lhs / 2 != rhs / 2 && literals[lhs].isSubsetOf(literals[rhs])) {
+                    implied.set(indexes[rhs / 2], rhs % 2 == 1);
+                    _isEmpty = false;
+                }
+            }
+        }
+    }
+}
+}  // namespace predicate_optimizer
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "predicate_optimizer/bitset_algebra.h"
+#include "predicate_optimizer/expression.h"
+#include <cstddef>
+#include <vector>
+
+namespace predicate_optimizer {
+/**
+ * Implications among the literals of the comparisons of the same path: the literal (i, value) of
+ * the predicate i implies the literal (j, value') if every value satisfying the first one satisfies
+ * the second one, e.g. a > 5 implies a >= 3 and a != 1. An exclusion is the implication of a
+ * negated literal: a > 5 implies !(a < 3). A minterm is contradictory if it conflicts with the
+ * literals implied by its own literals, which a single mask check finds. Intervals on a line are
+ * disjoint as soon as two of them are, so the pairwise implications find the contradictions of the
+ * intervals of a path, but not an intersection reduced to an excluded point, e.g.
+ * a >= 5 && a <= 5 && a != 5, which simplifyIntervals removes later. Paths of more than
+ * kMaxPredicatesPerPath comparisons are skipped to bound the quadratic cost of the matrix.
+ */
+class PredicateImplications {
+public:
+    static constexpr size_t kMaxPredicatesPerPath = 256;
+
+    explicit PredicateImplications(const std::vector<Expression>& predicates);
+
+    // Literals implied by the literal of the predicate, not including the literal itself.
+    const Minterm& implied(size_t predicate, bool value) const {
+        return _implied[2 * predicate + value];
+    }
+
+    // Return true if no literal implies another one.
+    bool empty() const {
+        return _isEmpty;
+    }
+
+    // The implied literals of every literal (i, value) at the index 2 * i + value, converted to the
+    // bitset type of a normal form.
+    template <typename BitsetT>
+    std::vector<BasicMinterm<BitsetT>> impliedLiterals() const {
+        std::vector<BasicMinterm<BitsetT>> result{};
+        result.reserve(_implied.size());
+        for (const auto& literals : _implied) {
+            result.emplace_back(minterm_cast<BitsetT>(literals));
+        }
+        return result;
+    }
+
+private:
+    std::vector<Minterm> _implied;
+    bool _isEmpty{true};
+};
+
+// Return true if the minterm conflicts with the literals implied by its literals, see
+// PredicateImplications::impliedLiterals.
+template <typename BitsetT>
+bool isContradictory(const BasicMinterm<BitsetT>& minterm,
+                     const std::vector<BasicMinterm<BitsetT>>& impliedLiterals) {
+    BasicMinterm<BitsetT> closure{};
+    minterm.mask.forEachSetBit([&](size_t i) {
+        const auto& literals = impliedLiterals[2 * i + minterm.bitset[i]];
+        closure.bitset |= literals.bitset;
+        closure.mask |= literals.mask;
+    });
+    return minterm.getConflicts(closure).any();
+}
+}  // namespace predicate_optimizer
@@ -0,0 +1,60 @@
+#include "Catch2/catch_amalgamated.hpp"
+#include "predicate_optimizer/expression_utils.h"
+#include "predicate_optimizer/predicate_implications.h"
+
+namespace predicate_optimizer {
+TEST_CASE("Predicate implications", "") {
+    std::vector<Expression> expressions{
+        makeGt("a", "5"),
+        makeGe("a", "3"),
+        makeEq("a", "1"),
+        makeGe("b", "3"),
+        makeIn("a", {"1", "2"}),
+    };
+    PredicateImplications implications{expressions};
+    REQUIRE(!implications.empty());
+
+    SECTION("a > 5 implies a >= 3 and a != 1") {
+        REQUIRE(implications.implied(0, true) == Minterm{"010", "110"});
+    }
+
+    SECTION("a < 3 implies a <= 5") {
+        REQUIRE(implications.implied(1, false) == Minterm{"0", "1"});
+    }
+
+    SECTION("a == 1 implies a <= 5 and a < 3") {
+        REQUIRE(implications.implied(2, true) == Minterm{"00", "11"});
+    }
+
+    SECTION("a != 1 implies nothing") {
+        REQUIRE(implications.implied(2, false) == Minterm{});
+    }
+
+    SECTION("Other paths and $in are independent") {
+        REQUIRE(implications.implied(3, true) == Minterm{});
+        REQUIRE(implications.implied(3, false) == Minterm{});
+        REQUIRE(implications.implied(4, true) == Minterm{});
+    }
+
+    SECTION("Contradictions") {
+        auto impliedLiterals = implications.impliedLiterals<Bitset>();
+        // a > 5 && a < 3
+        REQUIRE(isContradictory(Minterm{"00001", "00011"}, impliedLiterals));
+        // a == 1 && a >= 3
+        REQUIRE(isContradictory(Minterm{"00110", "00110"}, impliedLiterals));
+        // a > 5 && a != 1 && b >= 3 && a in [1, 2]
+        REQUIRE(!isContradictory(Minterm{"11001", "11101"}, impliedLiterals));
+        // a < 3 && a != 1
+        REQUIRE(!isContradictory(Minterm{"00000", "00110"}, impliedLiterals));
+    }
+
+    SECTION("Equal values of different types") {
+        PredicateImplications numbers{{makeGe("a", "5"), makeGt("a", "5.0"), makeEq("a", "5")}};
+        auto impliedLiterals = numbers.impliedLiterals<Bitset>();
+        // a > 5.0 && a == 5
+        REQUIRE(isContradictory(Minterm{"110", "110"}, impliedLiterals));
+        // a >= 5 && a <= 5.0 && a == 5
+        REQUIRE(!isContradictory(Minterm{"101", "111"}, impliedLiterals));
+    }
+}
+}  // namespace predicate_optimizer
@@ -1,86 +1,254 @@
 #include "quine_mccluskey.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <exception>
 #include <iostream>
 #include <iterator>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 namespace predicate_optimizer {
 namespace {
 
+template <typename BitsetT>
 struct MintermData {
-    MintermData(Bitset bitset, Bitset mask, std::vector<unsigned> coveredMinterms)
+    MintermData(BitsetT bitset, BitsetT mask, std::vector<unsigned> coveredMinterms)
         : bitset(std::move(bitset)),
           mask(std::move(mask)),
           coveredMinterms(std::move(coveredMinterms)),
           combined(false) {}
-    Bitset bitset;
-    Bitset mask;
+    BitsetT bitset;
+    BitsetT mask;
     std::vector<unsigned> coveredMinterms;
     bool combined;
 };
 
-// A utility class that helps to organise minterms by the number of bits set.
+// A utility class that helps to organise minterms by the number of bits set. Every minterm is kept
+// once, the covered minterms of an equal minterm inserted later are merged into it, so that every
+// level of the method is proportional to the number of distinct implicants.
+template <typename BitsetT>
 struct QmcTable {
     QmcTable() {}
 
-    QmcTable(std::vector<Minterm> minterms) {
+    QmcTable(const std::vector<Minterm>& minterms) {
         for (unsigned i = 0; i < static_cast<unsigned>(minterms.size()); ++i) {
-            insert(MintermData{std::move(minterms[i].bitset),
-                               std::move(minterms[i].mask),
-                               std::vector<unsigned>{i}});
+            insert(MintermData<BitsetT>{bitset_cast<BitsetT>(minterms[i].bitset),
+                                        bitset_cast<BitsetT>(minterms[i].mask),
+                                        std::vector<unsigned>{i}});
         }
     }
 
-    void insert(MintermData minterm) {
+    void insert(MintermData<BitsetT> minterm) {
         const auto count = minterm.bitset.count();
+        auto [pos, inserted] = positions.try_emplace({minterm.bitset, minterm.mask}, 0);
+        if (!inserted) {
+            auto& present = table[count][pos->second].coveredMinterms;
+            std::vector<unsigned> coveredMinterms{};
+            coveredMinterms.reserve(present.size() + minterm.coveredMinterms.size());
+            std::set_union(begin(present),
+                           end(present),
+                           begin(minterm.coveredMinterms),
+                           end(minterm.coveredMinterms),
+                           std::back_inserter(coveredMinterms));
+            present.swap(coveredMinterms);
+            return;
+        }
+
         if (table.size() <= count) {
             table.resize(count + 1);
         }
+        pos->second = table[count].size();
         table[count].emplace_back(std::move(minterm));
     }
 
+    // Return the minterm equal to the given one, or nullptr if there is none.
+    MintermData<BitsetT>* find(const BasicMinterm<BitsetT>& minterm) {
+        auto pos = positions.find(minterm);
+        if (pos == positions.end()) {
+            return nullptr;
+        }
+        return &table[minterm.bitset.count()][pos->second];
+    }
+
     bool empty() const {
         return table.empty();
     }
 
-    std::vector<std::vector<MintermData>> table;
+    size_t size() const {
+        return positions.size();
+    }
+
+    void append(QmcTable&& other) {
+        for (auto& group : other.table) {
+            for (auto& minterm : group) {
+                insert(std::move(minterm));
+            }
+        }
+    }
+
+    std::vector<std::vector<MintermData<BitsetT>>> table;
+    // Index of every minterm in its group.
+    std::unordered_map<BasicMinterm<BitsetT>, size_t> positions;
+};
+
+// Number of minterms of one group combined by one task.
+constexpr size_t kTaskSize = 1024;
+
+// Minterms [begin, end) of one group, combined with their neighbours from the next group.
+struct CombineTask {
+    size_t group;
+    size_t begin;
+    size_t end;
 };
 
-size_t countDifferentBits(const Bitset& lhs, const Bitset& rhs) {
-    return (lhs ^ rhs).count();
+/**
+ * Run task(0), ..., task(numTasks - 1) on up to numThreads threads, including the calling one. A
+ * thread which is done takes the next pending task, so that the threads stay busy when the tasks
+ * are of uneven size. The first exception thrown by a task is rethrown once all threads are done.
+ */
+template <typename Task>
+void runTasks(size_t numTasks, size_t numThreads, const Task& task) {
+    numThreads = std::min(numThreads, numTasks);
+    if (numThreads <= 1) {
+        for (size_t i = 0; i < numTasks; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> nextTask{0};
+    std::mutex errorMutex{};
+    std::exception_ptr error{};
+    auto worker = [&]() {
+        try {
+            for (size_t i = nextTask++; i < numTasks; i = nextTask++) {
+                task(i);
+            }
+        } catch (...) {
+            nextTask = numTasks;
+            std::lock_guard lock{errorMutex};
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads{};
+    threads.reserve(numThreads - 1);
+    for (size_t i = 1; i < numThreads; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+// Combine the minterms of the task with their neighbours. Only the combined flags of the task's
+// own minterms are set, the combined neighbours are returned in combinedNeighbours, so that the
+// tasks of different groups never write to the same minterm.
+template <typename BitsetT>
+void combineRange(QmcTable<BitsetT>& table,
+                  size_t groupIndex,
+                  size_t begin,
+                  size_t end,
+                  QmcTable<BitsetT>& result,
+                  std::vector<MintermData<BitsetT>*>& combinedNeighbours) {
+    auto& group = table.table[groupIndex];
+    for (size_t i = begin; i < end; ++i) {
+        auto& lhs = group[i];
+        BasicMinterm<BitsetT> neighbour{lhs.bitset, lhs.mask};
+        const auto unsetBits = lhs.mask ^ (lhs.mask & lhs.bitset);
+        unsetBits.forEachSetBit([&](size_t bit) {
+            neighbour.bitset.set(bit);
+            if (auto* rhs = table.find(neighbour)) {
+                lhs.combined = true;
+                combinedNeighbours.emplace_back(rhs);
+
+                std::vector<unsigned> coveredMinterms{};
+                coveredMinterms.reserve(lhs.coveredMinterms.size() + rhs->coveredMinterms.size());
+                std::merge(std::begin(lhs.coveredMinterms),
+                           std::end(lhs.coveredMinterms),
+                           std::begin(rhs->coveredMinterms),
+                           std::end(rhs->coveredMinterms),
+                           std::back_inserter(coveredMinterms));
+
+                auto mask = lhs.mask;
+                mask.reset(bit);
+                result.insert(
+                    MintermData<BitsetT>{lhs.bitset, std::move(mask), std::move(coveredMinterms)});
+            }
+            neighbour.bitset.reset(bit);
+        });
+    }
 }
 
 // Main step of the Quine-McCluskey method. It combines 2 minterms that differ by onnly one bit and
-// build new MC table for the next step.
-QmcTable combine(QmcTable& table) {
-    QmcTable result{};
-
-    for (size_t i = 0; i < table.table.size() - 1; ++i) {
-        for (auto& lhs : table.table[i]) {
-            for (auto& rhs : table.table[i + 1]) {
-                if (lhs.mask != rhs.mask) {
-                    continue;
-                }
-                auto differentBits = lhs.bitset ^ rhs.bitset;
-                if (differentBits.count() == 1) {
-                    lhs.combined = true;
-                    rhs.combined = true;
-
-                    std::vector<unsigned> coveredMinterms{};
-                    coveredMinterms.reserve(lhs.coveredMinterms.size() +
-                                            rhs.coveredMinterms.size());
-                    std::merge(begin(lhs.coveredMinterms),
-                               end(lhs.coveredMinterms),
-                               begin(rhs.coveredMinterms),
-                               end(rhs.coveredMinterms),
-                               std::back_inserter(coveredMinterms));
-                    result.insert(MintermData{lhs.bitset & rhs.bitset,
-                                              lhs.mask & ~differentBits,
-                                              std::move(coveredMinterms)});
+// build new MC table for the next step. Instead of comparing all pairs of adjacent groups, every
+// minterm looks up its neighbours obtained by setting one of its unset cared bits in the index of
+// the table. The groups are split in tasks which may run in parallel,
+// their results are appended in the order of the tasks, which is the order of the serial run.
+template <typename BitsetT>
+QmcTable<BitsetT> combine(QmcTable<BitsetT>& table, size_t numThreads) {
+    std::vector<CombineTask> tasks{};
+    for (size_t i = 0; i + 1 < table.table.size(); ++i) {
+        const size_t groupSize = table.table[i].size();
+        for (size_t begin = 0; begin < groupSize; begin += kTaskSize) {
+            tasks.push_back({i, begin, std::min(begin + kTaskSize, groupSize)});
+        }
+    }
+
+    std::vector<QmcTable<BitsetT>> results(tasks.size());
+    std::vector<std::vector<MintermData<BitsetT>*>> combinedNeighbours(tasks.size());
+    runTasks(tasks.size(), numThreads, [&](size_t t) {
+        const auto& task = tasks[t];
+        combineRange(table, task.group, task.begin, task.end, results[t], combinedNeighbours[t]);
+    });
+
+    QmcTable<BitsetT> result{};
+    for (size_t t = 0; t < tasks.size(); ++t) {
+        for (auto* rhs : combinedNeighbours[t]) {
+            rhs->combined = true;
+        }
+        result.append(std::move(results[t]));
+    }
+    return result;
+}
+
+template <typename BitsetT>
+std::unordered_set<QMCResult> runQuineMcCluskey(const std::vector<Minterm>& minterms,
+                                                const QmcOptions& options) {
+    const size_t numThreads = options.numThreads != 0
+        ? options.numThreads
+        : std::max<size_t>(1, std::thread::hardware_concurrency());
+
+    QmcTable<BitsetT> table{minterms};
+    std::unordered_set<QMCResult> result{};
+
+    while (!table.empty()) {
+        auto combinedTable =
+            combine(table, table.size() >= options.minParallelSize ? numThreads : 1);
+
+        for (auto&& tt : table.table) {
+            for (auto&& mt : tt) {
+                if (!mt.combined) {
+                    result.emplace(bitset_cast<Bitset>(mt.bitset),
+                                   bitset_cast<Bitset>(mt.mask),
+                                   std::move(mt.coveredMinterms));
                 }
             }
         }
+
+        std::swap(table, combinedTable);
     }
+
     return result;
 }
 }  // namespace
@@ -102,26 +270,16 @@ std::ostream& operator<<(std::ostream& os, const QMCResult& minterm) {
     return os;
 }
 
-std::unordered_set<QMCResult> quine_mccluskey(std::vector<Minterm> minterms) {
-    QmcTable table{std::move(minterms)};
-    std::unordered_set<QMCResult> result{};
-
-    while (!table.empty()) {
-        auto combinedTable = combine(table);
-
-        for (auto&& tt : table.table) {
-            for (auto&& mt : tt) {
-                if (!mt.combined) {
-                    result.emplace(
-                        std::move(mt.bitset), std::move(mt.mask), std::move(mt.coveredMinterms));
-                }
-            }
-        }
-
-        std::swap(table, combinedTable);
+std::unordered_set<QMCResult> quine_mccluskey(std::vector<Minterm> minterms,
+                                              const QmcOptions& options) {
+    size_t numBits = 0;
+    for (const auto& minterm : minterms) {
+        numBits = std::max(numBits, minterm.mask.significantWords() * Bitset::kWordBits);
     }
 
-    return result;
+    return dispatchByWidth(numBits, [&](auto bitsetType) {
+        return runQuineMcCluskey<typename decltype(bitsetType)::type>(minterms, options);
+    });
 }
 
 }  // namespace predicate_optimizer
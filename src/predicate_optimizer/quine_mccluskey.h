@@ -1,7 +1,7 @@
 #pragma once
 
 #include "predicate_optimizer/bitset_algebra.h"
-#include <bitset>
+#include <cstddef>
 #include <iosfwd>
 #include <unordered_set>
 #include <vector>
@@ -23,8 +23,16 @@ struct QMCResult {
 bool operator==(const QMCResult& lhs, const QMCResult& rhs);
 std::ostream& operator<<(std::ostream& os, const QMCResult& minterm);
 
-// The Quine-McCluskey method.
-std::unordered_set<QMCResult> quine_mccluskey(std::vector<Minterm> minterms);
+struct QmcOptions {
+    // Number of threads combining the minterms, 0 uses all hardware threads.
+    size_t numThreads{1};
+    // Levels with fewer minterms are combined on the calling thread.
+    size_t minParallelSize{4096};
+};
+
+// The Quine-McCluskey method. The result does not depend on the number of threads.
+std::unordered_set<QMCResult> quine_mccluskey(std::vector<Minterm> minterms,
+                                              const QmcOptions& options = {});
 
 }  // namespace predicate_optimizer
 
@@ -1,4 +1,6 @@
 #include "Catch2/catch_amalgamated.hpp"
+#include <bit>
+#include <random>
 #include <unordered_set>
 
 #include "quine_mccluskey.h"
@@ -104,5 +106,101 @@ TEST_CASE("Quine-mcCluskey", "") {
         auto result = quine_mccluskey(std::move(minterms));
         REQUIRE(expectedResult == result);
     }
+
+    SECTION("AB | A~B = A with 130 predicates") {
+        Minterm a(129, true);
+        a.set(0, true);
+        Minterm na(129, true);
+        na.set(0, false);
+        std::vector<Minterm> minterms{a, na};
+
+        auto result = quine_mccluskey(std::move(minterms));
+        REQUIRE(result.size() == 1);
+        REQUIRE(result.begin()->minterm == Minterm(129, true));
+        REQUIRE(result.begin()->coveredMinterms == std::vector<unsigned>{0, 1});
+    }
+
+    SECTION("duplicate minterms") {
+        Bitset mask{"11"};
+        std::vector<Minterm> minterms{
+            {"11"_b, mask},
+            {"10"_b, mask},
+            {"11"_b, mask},
+        };
+        std::unordered_set<QMCResult> expectedResult{
+            {"10"_b, "10"_b, {0, 1, 2}},
+        };
+
+        auto result = quine_mccluskey(std::move(minterms));
+        REQUIRE(expectedResult == result);
+    }
+
+    SECTION("all minterms of 10 predicates = true") {
+        // Without deduplication the implicants of the last levels are generated many times over.
+        std::vector<Minterm> minterms{};
+        std::vector<unsigned> coveredMinterms{};
+        for (unsigned value = 0; value < (1u << 10); ++value) {
+            Minterm minterm = Minterm::withSize(10);
+            for (size_t bit = 0; bit < 10; ++bit) {
+                minterm.set(bit, (value >> bit) & 1);
+            }
+            minterms.emplace_back(std::move(minterm));
+            coveredMinterms.emplace_back(value);
+        }
+        std::unordered_set<QMCResult> expectedResult{
+            {"0"_b, "0"_b, coveredMinterms},
+        };
+
+        auto result = quine_mccluskey(std::move(minterms));
+        REQUIRE(expectedResult == result);
+    }
+
+    SECTION("thousands of minterms") {
+        // Patterns of even parity differ in at least 2 bits, so every minterm combines only with
+        // its pair which differs in bit 0.
+        std::vector<Minterm> minterms{};
+        std::unordered_set<QMCResult> expectedResult{};
+        for (unsigned pattern = 0; pattern < (1u << 11); ++pattern) {
+            if (std::popcount(pattern) % 2 != 0) {
+                continue;
+            }
+            Minterm implicant = Minterm::withSize(12);
+            for (size_t bit = 0; bit < 11; ++bit) {
+                implicant.set(bit + 1, (pattern >> bit) & 1);
+            }
+            const auto index = static_cast<unsigned>(minterms.size());
+            for (bool value : {false, true}) {
+                Minterm minterm = implicant;
+                minterm.set(0, value);
+                minterms.emplace_back(std::move(minterm));
+            }
+            expectedResult.insert({implicant.bitset, implicant.mask, {index, index + 1}});
+        }
+        REQUIRE(minterms.size() == 2048);
+
+        auto result = quine_mccluskey(std::move(minterms));
+        REQUIRE(expectedResult == result);
+    }
+}
+
+TEST_CASE("Parallel Quine-McCluskey", "") {
+    std::mt19937 gen{42};
+    std::vector<Minterm> minterms{};
+    for (unsigned value = 0; value < (1u << 12); ++value) {
+        if (gen() % 4 != 0) {
+            continue;
+        }
+        Minterm minterm = Minterm::withSize(12);
+        for (size_t bit = 0; bit < 12; ++bit) {
+            minterm.set(bit, (value >> bit) & 1);
+        }
+        minterms.emplace_back(std::move(minterm));
+    }
+
+    const auto expectedResult = quine_mccluskey(minterms);
+    for (size_t numThreads : {2, 4, 0}) {
+        auto result = quine_mccluskey(minterms, {.numThreads = numThreads, .minParallelSize = 0});
+        REQUIRE(expectedResult == result);
+    }
 }
 }  // namespace predicate_optimizer
@@ -0,0 +1,116 @@
+#include "predicate_optimizer/symbol.h"
+
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <unordered_set>
+
+namespace predicate_optimizer {
+namespace {
+// Hash and equality of the entries by their strings, which can be looked up by string_view.
+struct EntryHash {
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view str) const noexcept {
+        return std::hash<std::string_view>{}(str);
+    }
+
+    std::size_t operator()(const Symbol::Entry& entry) const noexcept {
+        return (*this)(std::string_view{entry.str});
+    }
+};
+
+struct EntryEqual {
+    using is_transparent = void;
+
+    static std::string_view key(std::string_view str) {
+        return str;
+    }
+
+    static std::string_view key(const Symbol::Entry& entry) {
+        return entry.str;
+    }
+
+    template <typename L, typename R>
+    bool operator()(const L& lhs, const R& rhs) const noexcept {
+        return key(lhs) == key(rhs);
+    }
+};
+
+// Interned strings, the nodes of the set are never moved, so that the pointers to them are stable.
+// A reference count drops to zero under the exclusive lock only, and is incremented from zero
+// never, since the lookups hold the lock and remove nothing, so that an entry found in the table
+// is alive.
+struct SymbolTable {
+    std::shared_mutex mutex;
+    std::unordered_set<Symbol::Entry, EntryHash, EntryEqual> entries;
+    const Symbol::Entry* empty{&*entries.emplace(std::string_view{}, true).first};
+};
+
+SymbolTable& symbolTable() {
+    static SymbolTable table{};
+    return table;
+}
+
+// Add a reference to the entry found in the table, or return null.
+template <typename Entries>
+const Symbol::Entry* acquire(const Entries& entries, std::string_view str) {
+    auto pos = entries.find(str);
+    if (pos == entries.end()) {
+        return nullptr;
+    }
+    if (!pos->isPinned) {
+        pos->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return &*pos;
+}
+}  // namespace
+
+const Symbol::Entry* Symbol::emptyEntry() noexcept {
+    static const Entry* empty = symbolTable().empty;
+    return empty;
+}
+
+const Symbol::Entry* Symbol::intern(std::string_view str) {
+    auto& table = symbolTable();
+    {
+        std::shared_lock lock{table.mutex};
+        if (const auto* entry = acquire(table.entries, str)) {
+            return entry;
+        }
+    }
+
+    std::unique_lock lock{table.mutex};
+    if (const auto* entry = acquire(table.entries, str)) {
+        return entry;
+    }
+    return &*table.entries.emplace(str, false).first;
+}
+
+void Symbol::release(const Entry* entry) noexcept {
+    // Other references remain, the entry stays in the table.
+    auto refs = entry->refs.load(std::memory_order_relaxed);
+    while (refs > 1) {
+        if (entry->refs.compare_exchange_weak(refs, refs - 1, std::memory_order_acq_rel)) {
+            return;
+        }
+    }
+
+    // Possibly the last reference, a concurrent intern() may add one until the lock is held.
+    auto& table = symbolTable();
+    std::unique_lock lock{table.mutex};
+    if (entry->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        table.entries.erase(table.entries.find(std::string_view{entry->str}));
+    }
+}
+
+std::size_t Symbol::numInterned() {
+    auto& table = symbolTable();
+    std::shared_lock lock{table.mutex};
+    return table.entries.size();
+}
+
+std::ostream& operator<<(std::ostream& os, const Symbol& symbol) {
+    return os << symbol.str();
+}
+}  // namespace predicate_optimizer
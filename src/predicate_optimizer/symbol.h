@@ -0,0 +1,124 @@
+#pragma once
+
+#include "predicate_optimizer/typed_value.h"
+#include <atomic>
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace predicate_optimizer {
+/**
+ * Interned string. Equal strings share one entry of a process-wide symbol table, so that a Symbol
+ * is a single pointer: copies are cheap, and equality and hashing are O(1). Ordering compares the
+ * strings. Every string is parsed into a TypedValue once, when it is interned, so that comparisons
+ * of values do not parse them again. The table is thread-safe. The entries are reference counted:
+ * an entry lives as long as a Symbol refers to it, and is removed from the table with the last
+ * one, so that the table holds the strings of the live expressions only. The empty string is
+ * never removed, it is the value of the default and moved-from symbols.
+ */
+class Symbol {
+public:
+    Symbol() noexcept : _entry(emptyEntry()) {}
+    Symbol(std::string_view str) : _entry(intern(str)) {}
+    Symbol(const std::string& str) : Symbol(std::string_view{str}) {}
+    Symbol(const char* str) : Symbol(std::string_view{str}) {}
+
+    Symbol(const Symbol& other) noexcept : _entry(other._entry) {
+        if (!_entry->isPinned) {
+            _entry->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    Symbol(Symbol&& other) noexcept : _entry(std::exchange(other._entry, emptyEntry())) {}
+
+    Symbol& operator=(const Symbol& other) noexcept {
+        Symbol copy{other};
+        std::swap(_entry, copy._entry);
+        return *this;
+    }
+
+    Symbol& operator=(Symbol&& other) noexcept {
+        std::swap(_entry, other._entry);
+        return *this;
+    }
+
+    ~Symbol() {
+        if (!_entry->isPinned) {
+            release(_entry);
+        }
+    }
+
+    // Number of strings in the symbol table.
+    static std::size_t numInterned();
+
+    const std::string& str() const noexcept {
+        return _entry->str;
+    }
+
+    operator std::string_view() const noexcept {
+        return _entry->str;
+    }
+
+    // The string parsed into a typed value.
+    const TypedValue& typed() const noexcept {
+        return _entry->typed;
+    }
+
+    bool operator==(const Symbol& other) const noexcept {
+        return _entry == other._entry;
+    }
+
+    std::strong_ordering operator<=>(const Symbol& other) const noexcept {
+        if (_entry == other._entry) {
+            return std::strong_ordering::equal;
+        }
+        return _entry->str <=> other._entry->str;
+    }
+
+    std::size_t hash() const noexcept {
+        return std::hash<const void*>{}(_entry);
+    }
+
+    struct Entry {
+        Entry(std::string_view str, bool isPinned)
+            : str(str), typed(TypedValue::parse(this->str)), isPinned(isPinned) {}
+
+        Entry(const Entry&) = delete;
+        Entry& operator=(const Entry&) = delete;
+
+        std::string str;
+        TypedValue typed;
+        // Pinned entries are not reference counted and never removed.
+        bool isPinned;
+        // Number of symbols referring to the entry.
+        mutable std::atomic<std::size_t> refs{1};
+    };
+
+private:
+    // Return the entry of the string with a new reference.
+    static const Entry* intern(std::string_view str);
+    static const Entry* emptyEntry() noexcept;
+    // Drop a reference, the entry is removed from the table with the last one.
+    static void release(const Entry* entry) noexcept;
+
+    const Entry* _entry;
+};
+
+std::ostream& operator<<(std::ostream& os, const Symbol& symbol);
+}  // namespace predicate_optimizer
+
+namespace std {
+template <>
+struct hash<predicate_optimizer::Symbol> {
+    using argument_type = predicate_optimizer::Symbol;
+    using result_type = std::size_t;
+
+    result_type operator()(const argument_type& symbol) const noexcept {
+        return symbol.hash();
+    }
+};
+}  // namespace std
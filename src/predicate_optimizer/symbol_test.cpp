@@ -0,0 +1,92 @@
+#include "Catch2/catch_amalgamated.hpp"
+#include "symbol.h"
+
+#include <atomic>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace predicate_optimizer {
+TEST_CASE("Symbol", "") {
+    SECTION("Equal strings are interned once") {
+        std::string str{"a.b"};
+        Symbol lhs{str};
+        Symbol rhs{"a.b"};
+        REQUIRE(lhs == rhs);
+        REQUIRE(&lhs.str() == &rhs.str());
+        REQUIRE(std::hash<Symbol>{}(lhs) == std::hash<Symbol>{}(rhs));
+        REQUIRE(lhs != Symbol{"a.c"});
+    }
+
+    SECTION("Default symbol is the empty string") {
+        REQUIRE(Symbol{} == Symbol{""});
+        REQUIRE(Symbol{}.str().empty());
+    }
+
+    SECTION("Ordering compares strings") {
+        REQUIRE(Symbol{"abc"} < Symbol{"abd"});
+        REQUIRE(Symbol{"b"} > Symbol{"abc"});
+        REQUIRE(Symbol{"10"} < Symbol{"9"});
+        REQUIRE((Symbol{"x"} <=> Symbol{"x"}) == std::strong_ordering::equal);
+    }
+
+    SECTION("Print") {
+        std::ostringstream os{};
+        os << Symbol{"hello"};
+        REQUIRE(os.str() == "hello");
+    }
+
+    SECTION("Concurrent interning") {
+        std::vector<std::vector<Symbol>> symbols(4);
+        std::vector<std::thread> threads{};
+        for (auto& result : symbols) {
+            threads.emplace_back([&result]() {
+                for (int i = 0; i < 1000; ++i) {
+                    result.emplace_back(std::to_string(i));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        for (const auto& result : symbols) {
+            REQUIRE(result == symbols.front());
+        }
+    }
+
+    SECTION("Entries are removed with their last symbol") {
+        const size_t numInterned = Symbol::numInterned();
+        {
+            Symbol symbol{"symbol-test-value"};
+            Symbol copy = symbol;
+            Symbol moved = std::move(symbol);
+            REQUIRE(Symbol::numInterned() == numInterned + 1);
+            REQUIRE(symbol == Symbol{});
+            REQUIRE(moved == copy);
+        }
+        REQUIRE(Symbol::numInterned() == numInterned);
+    }
+
+    SECTION("Concurrent interning and removal") {
+        const size_t numInterned = Symbol::numInterned();
+        std::atomic<size_t> numMismatches{0};
+        std::vector<std::thread> threads{};
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&numMismatches]() {
+                for (int i = 0; i < 20000; ++i) {
+                    const auto str = "symbol-test-" + std::to_string(i % 7);
+                    Symbol symbol{str};
+                    Symbol copy = symbol;
+                    numMismatches += copy.str() != str;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        REQUIRE(numMismatches == 0);
+        REQUIRE(Symbol::numInterned() == numInterned);
+    }
+}
+}  // namespace predicate_optimizer
@@ -0,0 +1,315 @@
+#include "predicate_optimizer/typed_value.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <optional>
+#include <ostream>
+
+namespace predicate_optimizer {
+namespace {
+// Largest number of digits of the unscaled value of a decimal, 10^18 fits int64_t.
+constexpr size_t kMaxDecimalDigits = 18;
+
+constexpr std::array<int64_t, kMaxDecimalDigits + 1> kPowersOf10 = []() {
+    std::array<int64_t, kMaxDecimalDigits + 1> powers{};
+    powers[0] = 1;
+    for (size_t i = 1; i < powers.size(); ++i) {
+        powers[i] = powers[i - 1] * 10;
+    }
+    return powers;
+}();
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+bool isDigits(std::string_view str) {
+    return !str.empty() && std::all_of(begin(str), end(str), isDigit);
+}
+
+std::optional<int64_t> parseInt64(std::string_view str) {
+    int64_t value{};
+    auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (ec != std::errc{} || ptr != str.data() + str.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// Parse -?digits.digits into the unscaled value and the scale.
+std::optional<std::pair<int64_t, uint8_t>> parseDecimal(std::string_view str) {
+    const bool isNegative = str.starts_with('-');
+    const auto digits = str.substr(isNegative ? 1 : 0);
+    const auto point = digits.find('.');
+    if (point == std::string_view::npos) {
+        return std::nullopt;
+    }
+    auto integerPart = digits.substr(0, point);
+    const auto fractionPart = digits.substr(point + 1);
+    if (!isDigits(integerPart) || !isDigits(fractionPart) ||
+        fractionPart.size() > kMaxDecimalDigits) {
+        return std::nullopt;
+    }
+
+    integerPart.remove_prefix(std::min(integerPart.find_first_not_of('0'), integerPart.size()));
+    if (integerPart.size() + fractionPart.size() > kMaxDecimalDigits) {
+        return std::nullopt;
+    }
+
+    int64_t unscaled = 0;
+    for (char c : integerPart) {
+        unscaled = unscaled * 10 + (c - '0');
+    }
+    for (char c : fractionPart) {
+        unscaled = unscaled * 10 + (c - '0');
+    }
+    return std::pair{isNegative ? -unscaled : unscaled, static_cast<uint8_t>(fractionPart.size())};
+}
+
+// Parse a finite number in decimal or scientific notation, "inf" and "nan" are strings.
+std::optional<double> parseDouble(std::string_view str) {
+    const bool isNumeric = !str.empty() && std::all_of(begin(str), end(str), [](char c) {
+        return isDigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+    });
+    if (!isNumeric) {
+        return std::nullopt;
+    }
+
+    double value{};
+    auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (ec != std::errc{} || ptr != str.data() + str.size() || !std::isfinite(value)) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// Parse the digits [pos, pos + numDigits) of the string.
+std::optional<int> parseDigits(std::string_view str, size_t pos, size_t numDigits) {
+    if (pos + numDigits > str.size() || !isDigits(str.substr(pos, numDigits))) {
+        return std::nullopt;
+    }
+    int value = 0;
+    for (char c : str.substr(pos, numDigits)) {
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
+
+// Parse YYYY-MM-DD, optionally followed by THH:MM:SS, optional milliseconds .fff and Z, into the
+// milliseconds since the Unix epoch. Other time zones are not supported.
+std::optional<int64_t> parseDate(std::string_view str) {
+    using namespace std::chrono;
+
+    if (str.size() < 10 || str[4] != '-' || str[7] != '-') {
+        return std::nullopt;
+    }
+    auto y = parseDigits(str, 0, 4);
+    auto m = parseDigits(str, 5, 2);
+    auto d = parseDigits(str, 8, 2);
+    if (!y || !m || !d) {
+        return std::nullopt;
+    }
+    const year_month_day date{year{*y}, month{static_cast<unsigned>(*m)},
+                              day{static_cast<unsigned>(*d)}};
+    if (!date.ok()) {
+        return std::nullopt;
+    }
+    auto time = duration_cast<milliseconds>(sys_days{date}.time_since_epoch());
+    if (str.size() == 10) {
+        return time.count();
+    }
+
+    if (str.size() < 19 || str[10] != 'T' || str[13] != ':' || str[16] != ':') {
+        return std::nullopt;
+    }
+    auto h = parseDigits(str, 11, 2);
+    auto min = parseDigits(str, 14, 2);
+    auto s = parseDigits(str, 17, 2);
+    if (!h || !min || !s || *h > 23 || *min > 59 || *s > 59) {
+        return std::nullopt;
+    }
+    time += hours{*h} + minutes{*min} + seconds{*s};
+
+    size_t pos = 19;
+    if (pos < str.size() && str[pos] == '.') {
+        auto ms = parseDigits(str, pos + 1, 3);
+        if (!ms) {
+            return std::nullopt;
+        }
+        time += milliseconds{*ms};
+        pos += 4;
+    }
+    if (pos < str.size() && str[pos] == 'Z') {
+        ++pos;
+    }
+    if (pos != str.size()) {
+        return std::nullopt;
+    }
+    return time.count();
+}
+
+// Numbers, strings and dates, in the order of the categories.
+int category(TypedValue::Type type) {
+    switch (type) {
+        case TypedValue::Type::Int64:
+            [[fallthrough]];
+        case TypedValue::Type::Decimal:
+            [[fallthrough]];
+        case TypedValue::Type::Double:
+            return 0;
+        case TypedValue::Type::String:
+            return 1;
+        case TypedValue::Type::Date:
+            return 2;
+    }
+    __builtin_unreachable();
+}
+
+template <typename T>
+std::weak_ordering compareNumbers(T lhs, T rhs) {
+    if (lhs < rhs) {
+        return std::weak_ordering::less;
+    }
+    return lhs > rhs ? std::weak_ordering::greater : std::weak_ordering::equivalent;
+}
+
+using Uint128 = unsigned __int128;
+
+// Compare the positive decimal magnitude / 10^scale with the positive finite double exactly. The
+// double is mantissa / 2^shift for an integer mantissa of 53 bits, both sides are multiplied by
+// 10^scale: the magnitude is compared with the quotient and the remainder of mantissa * 10^scale
+// divided by 2^shift.
+std::weak_ordering compareMagnitudes(Uint128 magnitude, uint8_t scale, double value) {
+    int exponent = 0;
+    const double fraction = std::frexp(value, &exponent);
+    const auto mantissa = static_cast<Uint128>(std::ldexp(fraction, 53));
+    const Uint128 power = kPowersOf10[scale];
+
+    const int shift = 53 - exponent;
+    if (shift <= 0) {
+        // A double of 2^64 or more is larger than any decimal, smaller ones times 10^18 fit.
+        if (exponent > 64) {
+            return std::weak_ordering::less;
+        }
+        return compareNumbers(magnitude, (mantissa << -shift) * power);
+    }
+
+    const Uint128 scaled = mantissa * power;
+    if (shift >= 128) {
+        return compareNumbers(magnitude, Uint128{0});
+    }
+    const Uint128 quotient = scaled >> shift;
+    if (magnitude != quotient) {
+        return compareNumbers(magnitude, quotient);
+    }
+    const bool hasRemainder = (scaled & ((Uint128{1} << shift) - 1)) != 0;
+    return hasRemainder ? std::weak_ordering::less : std::weak_ordering::equivalent;
+}
+
+// Compare the decimal unscaled / 10^scale, or an integer of scale 0, with the double exactly.
+std::weak_ordering compareWithDouble(int64_t unscaled, uint8_t scale, double value) {
+    const int sign = (unscaled > 0) - (unscaled < 0);
+    const int valueSign = (value > 0) - (value < 0);
+    if (sign != valueSign || sign == 0) {
+        return sign <=> valueSign;
+    }
+
+    // The magnitude of the smallest int64_t fits the unsigned type.
+    const auto magnitude = static_cast<Uint128>(sign > 0 ? __int128{unscaled}
+                                                                   : -__int128{unscaled});
+    const auto result = compareMagnitudes(magnitude, scale, std::abs(value));
+    return sign > 0 ? result : 0 <=> result;
+}
+}  // namespace
+
+TypedValue TypedValue::parse(std::string_view str) {
+    TypedValue result{str};
+    if (auto value = parseInt64(str)) {
+        result._type = Type::Int64;
+        result._int = *value;
+    } else if (auto decimal = parseDecimal(str)) {
+        result._type = Type::Decimal;
+        result._int = decimal->first;
+        result._scale = decimal->second;
+    } else if (auto value = parseDouble(str)) {
+        result._type = Type::Double;
+        result._double = *value;
+    } else if (auto time = parseDate(str)) {
+        result._type = Type::Date;
+        result._int = *time;
+    }
+    return result;
+}
+
+double TypedValue::toDouble() const noexcept {
+    switch (_type) {
+        case Type::Int64:
+            return static_cast<double>(_int);
+        case Type::Decimal:
+            return static_cast<double>(_int) / static_cast<double>(kPowersOf10[_scale]);
+        case Type::Double:
+            return _double;
+        case Type::String:
+            [[fallthrough]];
+        case Type::Date:
+            return std::nan("");
+    }
+    __builtin_unreachable();
+}
+
+std::weak_ordering TypedValue::operator<=>(const TypedValue& other) const noexcept {
+    const int lhsCategory = category(_type);
+    const int rhsCategory = category(other._type);
+    if (lhsCategory != rhsCategory) {
+        return lhsCategory <=> rhsCategory;
+    }
+
+    switch (_type) {
+        case Type::String:
+            return _str <=> other._str;
+        case Type::Date:
+            return _int <=> other._int;
+        case Type::Int64:
+            [[fallthrough]];
+        case Type::Decimal:
+            [[fallthrough]];
+        case Type::Double:
+            if (_type == Type::Double && other._type == Type::Double) {
+                return compareNumbers(_double, other._double);
+            }
+            // Integers and decimals are compared with doubles exactly, rounding them to doubles
+            // would make the equality of numbers non-transitive.
+            if (_type == Type::Double) {
+                return 0 <=> compareWithDouble(other._int, other._scale, _double);
+            }
+            if (other._type == Type::Double) {
+                return compareWithDouble(_int, _scale, other._double);
+            }
+            // Integers are decimals of scale 0, both sides are scaled to the larger scale, the
+            // product of an int64_t and 10^18 fits __int128.
+            const uint8_t scale = std::max(_scale, other._scale);
+            return compareNumbers(__int128{_int} * kPowersOf10[scale - _scale],
+                                  __int128{other._int} * kPowersOf10[scale - other._scale]);
+    }
+    __builtin_unreachable();
+}
+
+std::ostream& operator<<(std::ostream& os, TypedValue::Type type) {
+    switch (type) {
+        case TypedValue::Type::Int64:
+            return os << "Int64";
+        case TypedValue::Type::Decimal:
+            return os << "Decimal";
+        case TypedValue::Type::Double:
+            return os << "Double";
+        case TypedValue::Type::String:
+            return os << "String";
+        case TypedValue::Type::Date:
+            return os << "Date";
+    }
+    __builtin_unreachable();
+}
+}  // namespace predicate_optimizer
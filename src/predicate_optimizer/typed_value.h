@@ -0,0 +1,69 @@
+#pragma once
+
+#include <compare>
+#include <cstdint>
+#include <iosfwd>
+#include <string_view>
+
+namespace predicate_optimizer {
+/**
+ * Value of a comparison parsed into its type: a 64-bit integer, a fixed-point decimal of up to 18
+ * digits, a double in scientific notation, an ISO 8601 date, or a string otherwise. Numbers of all
+ * types compare exactly by their numeric values, so that the ordering is a strict weak order.
+ * Values of different categories are ordered numbers < strings < dates, like BSON. Strings are not
+ * copied, a TypedValue must not outlive the string it was parsed from.
+ */
+class TypedValue {
+public:
+    enum class Type : uint8_t { Int64, Decimal, Double, String, Date };
+
+    TypedValue() : TypedValue(std::string_view{}) {}
+
+    // Parse the string, the type is the first one of Int64, Decimal, Double and Date the string is
+    // a valid representation of, String otherwise.
+    static TypedValue parse(std::string_view str);
+
+    Type type() const noexcept {
+        return _type;
+    }
+
+    bool isNumber() const noexcept {
+        return _type == Type::Int64 || _type == Type::Decimal || _type == Type::Double;
+    }
+
+    std::weak_ordering operator<=>(const TypedValue& other) const noexcept;
+
+    bool operator==(const TypedValue& other) const noexcept {
+        return (*this <=> other) == 0;
+    }
+
+    int64_t int64() const noexcept {
+        return _int;
+    }
+
+    double toDouble() const noexcept;
+
+    // Milliseconds since the Unix epoch of a date.
+    int64_t millisSinceEpoch() const noexcept {
+        return _int;
+    }
+
+    std::string_view string() const noexcept {
+        return _str;
+    }
+
+private:
+    explicit TypedValue(std::string_view str) : _type(Type::String), _str(str) {}
+
+    Type _type;
+    // Number of digits after the decimal point of a decimal, whose unscaled value is _int.
+    uint8_t _scale{0};
+    union {
+        int64_t _int{0};
+        double _double;
+    };
+    std::string_view _str;
+};
+
+std::ostream& operator<<(std::ostream& os, TypedValue::Type type);
+}  // namespace predicate_optimizer
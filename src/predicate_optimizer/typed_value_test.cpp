@@ -0,0 +1,90 @@
+#include "Catch2/catch_amalgamated.hpp"
+#include "symbol.h"
+#include "typed_value.h"
+#include <vector>
+
+namespace predicate_optimizer {
+TEST_CASE("Typed value", "") {
+    SECTION("Types") {
+        REQUIRE(TypedValue::parse("42").type() == TypedValue::Type::Int64);
+        REQUIRE(TypedValue::parse("-42").int64() == -42);
+        REQUIRE(TypedValue::parse("-1.50").type() == TypedValue::Type::Decimal);
+        REQUIRE(TypedValue::parse("-1.50").toDouble() == -1.5);
+        REQUIRE(TypedValue::parse("1e3").type() == TypedValue::Type::Double);
+        REQUIRE(TypedValue::parse("99999999999999999999").type() == TypedValue::Type::Double);
+        REQUIRE(TypedValue::parse("2024-02-29").type() == TypedValue::Type::Date);
+        REQUIRE(TypedValue::parse("1970-01-02T00:00:01.5Z").type() == TypedValue::Type::String);
+        REQUIRE(TypedValue::parse("1970-01-02T00:00:01.500Z").millisSinceEpoch() == 86401500);
+        REQUIRE(TypedValue::parse("2023-02-29").type() == TypedValue::Type::String);
+        REQUIRE(TypedValue::parse("inf").type() == TypedValue::Type::String);
+        REQUIRE(TypedValue::parse("-").type() == TypedValue::Type::String);
+        REQUIRE(TypedValue::parse("").type() == TypedValue::Type::String);
+        REQUIRE(TypedValue::parse("abc").string() == "abc");
+    }
+
+    SECTION("Numbers compare by value") {
+        REQUIRE(TypedValue::parse("9") < TypedValue::parse("10"));
+        REQUIRE(TypedValue::parse("-11") < TypedValue::parse("-2"));
+        REQUIRE(TypedValue::parse("5") == TypedValue::parse("5.00"));
+        REQUIRE(TypedValue::parse("0.1") < TypedValue::parse("0.10000000000000001"));
+        REQUIRE(TypedValue::parse("9223372036854775807") >
+                TypedValue::parse("999999999999.999999"));
+        REQUIRE(TypedValue::parse("1e3") == TypedValue::parse("1000"));
+        REQUIRE(TypedValue::parse("2.5e-1") < TypedValue::parse("0.3"));
+    }
+
+    SECTION("Integers and decimals compare exactly with doubles") {
+        // 2^53 + 1 rounds to the double 2^53.
+        REQUIRE(TypedValue::parse("9007199254740993") > TypedValue::parse("9007199254740992.0e0"));
+        REQUIRE(TypedValue::parse("9007199254740992") == TypedValue::parse("9007199254740992.0e0"));
+        // The double 1e-1 is 0.1000000000000000055511151231257827...
+        REQUIRE(TypedValue::parse("0.1") < TypedValue::parse("1e-1"));
+        REQUIRE(TypedValue::parse("0.10000000000000001") > TypedValue::parse("1e-1"));
+        REQUIRE(TypedValue::parse("-0.1") > TypedValue::parse("-1e-1"));
+        REQUIRE(TypedValue::parse("0.5") == TypedValue::parse("5e-1"));
+        REQUIRE(TypedValue::parse("-9223372036854775808") ==
+                TypedValue::parse("-9.223372036854775808e18"));
+        REQUIRE(TypedValue::parse("9223372036854775807") <
+                TypedValue::parse("9.2233720368547758e18"));
+        REQUIRE(TypedValue::parse("1") > TypedValue::parse("1e-300"));
+        REQUIRE(TypedValue::parse("0") > TypedValue::parse("-1e-300"));
+        REQUIRE(TypedValue::parse("-1") > TypedValue::parse("-1e300"));
+    }
+
+    SECTION("The ordering of numbers is transitive") {
+        std::vector<TypedValue> values{};
+        for (const char* str : {"9007199254740991", "9007199254740992", "9007199254740993",
+                                "9007199254740992.0e0", "9.007199254740994e15", "0.1",
+                                "0.10000000000000001", "0.09999999999999999", "1e-1", "1.0e-1",
+                                "-0.1", "-1e-1", "0", "0e0", "-0.0", "2.5e-1", "0.25", "1000"}) {
+            values.push_back(TypedValue::parse(str));
+        }
+        size_t numViolations = 0;
+        for (const auto& a : values) {
+            for (const auto& b : values) {
+                numViolations += (a < b) != (b > a) ? 1 : 0;
+                for (const auto& c : values) {
+                    numViolations += a == b && b == c && a != c ? 1 : 0;
+                    numViolations += a < b && b <= c && !(a < c) ? 1 : 0;
+                }
+            }
+        }
+        REQUIRE(numViolations == 0);
+    }
+
+    SECTION("Categories") {
+        REQUIRE(TypedValue::parse("1e300") < TypedValue::parse(""));
+        REQUIRE(TypedValue::parse("abc") < TypedValue::parse("abd"));
+        REQUIRE(TypedValue::parse("zzz") < TypedValue::parse("1970-01-01"));
+        REQUIRE(TypedValue::parse("1969-12-31T23:59:59") < TypedValue::parse("1970-01-01"));
+    }
+
+    SECTION("Symbols are parsed once") {
+        Symbol value{"10"};
+        REQUIRE(value.typed().type() == TypedValue::Type::Int64);
+        REQUIRE(&value.typed() == &Symbol{"10"}.typed());
+        REQUIRE(value.typed() > Symbol{"9"}.typed());
+        REQUIRE(value < Symbol{"9"});
+    }
+}
+}  // namespace predicate_optimizer